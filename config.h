@@ -31,8 +31,19 @@ static const Bool	highlightfocused	= True;
 static const Bool	scrolltofocused		= True;
 static const Bool	animations			= True;
 static const Bool	activeedges			= True;
+static const Bool	canvasmode			= False;	/* pan by moving one parent window */
+static const Bool	overviewzoom		= True;		/* scaled previews (needs Composite) */
 static const Bool	tagpoints			= False;
-static const int	animatespeed		= 18;
+static const int	animatetime			= 200;	/* ms per pan or checkpoint jump */
+static const int	animaterate			= 60;	/* frames per second, match the display */
+static const int	zoomdelay			= 60;	/* ms to gather wheel zoom ticks into one */
+static const int	resizerate			= 0;	/* live resizes per second while dragging, 0 waits for release */
+static const Bool	resizeoutline		= True;	/* frame the pending size while dragging */
+static const Bool	syncresize			= True;	/* pace resizes with _NET_WM_SYNC_REQUEST */
+static const int	synctimeout			= 250;	/* ms to wait for a client to catch up */
+static const Bool	shmstatus			= True;	/* offer commands a shared memory channel */
+static const int	statusrate			= 20;	/* default status repaints per second, "rate:cmd" overrides */
+static const Bool	poolstats			= False;	/* print allocator usage on exit */
 static Bool			autoretile			= True;
 static const int	borderwidth			= 1;
 static const int	tilegap				= 4;
@@ -81,6 +92,7 @@ static Key keys[] = {
 	{ MOD1|MOD2,		XK_k,		move,		"up"			},
 	{ MOD1|MOD2,		XK_h,		move,		"left"			},
 	{ MOD1|MOD2,		XK_l,		move,		"right"			},
+	{ MOD1|MOD2,		XK_o,		desktop,	"overview"		},
 	/* client swapping */
 	{ MOD1,				XK_j,		shift,		"left"			},
 	{ MOD1,				XK_k,		shift,		"right"			},
@@ -92,6 +104,11 @@ static Key keys[] = {
 	{ MOD1|MOD2,		XK_Tab, 	cycle,		"tag"			},
 	{ MOD1|ControlMask,	XK_Tab, 	cycle,		"visible"		},
 	{ MOD1,				XK_grave, 	cycle,		"other"			},
+	/* directional focus */
+	{ MOD1,				XK_Left,	focusdir,	"left"			},
+	{ MOD1,				XK_Right,	focusdir,	"right"			},
+	{ MOD1,				XK_Up,		focusdir,	"up"			},
+	{ MOD1,				XK_Down,	focusdir,	"down"			},
 	/* select tag */
 	{ MOD1,				XK_1,		tag,		"1"				},
 	{ MOD1,				XK_2,		tag,		"2"				},
@@ -1,279 +1,263 @@
-
 #ifndef __SCWM_ICONS_H__
-#define __SCWM_ICONS_H__		"SCWM Icons 0.5"
+#define __SCWM_ICONS_H__		"SCWM Icons 0.6"
 
-#define MAKE_ICON(x)	{ (sizeof(x)/sizeof(x[0])), (XPoint *) x }
+#define MAKE_ICON(x)	{ x }
 
 /* TODO: power (ie charging), what else? */
 
 static const int iconwidth = 10;
 static const int iconheight = 10;
 
+/* XBM bitmaps: each row is two bytes, least significant bit leftmost */
 typedef struct Icon {
-	int n;
-	XPoint *pts;
+	const unsigned char *bits;
 } Icon;
 
-/*
-static const XPoint template_icon[] = {
-	{0,0},	{1,0},	{2,0},	{3,0},	{4,0},	{5,0},	{6,0},	{7,0},	{8,0},	{9,0},
-	{0,1},	{1,1},	{2,1},	{3,1},	{4,1},	{5,1},	{6,1},	{7,1},	{8,1},	{9,1},
-	{0,2},	{1,2},	{2,2},	{3,2},	{4,2},	{5,2},	{6,2},	{7,2},	{8,2},	{9,2},
-	{0,3},	{1,3},	{2,3},	{3,3},	{4,3},	{5,3},	{6,3},	{7,3},	{8,3},	{9,3},
-	{0,4},	{1,4},	{2,4},	{3,4},	{4,4},	{5,4},	{6,4},	{7,4},	{8,4},	{9,4},
-	{0,5},	{1,5},	{2,5},	{3,5},	{4,5},	{5,5},	{6,5},	{7,5},	{8,5},	{9,5},
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},	{8,6},	{9,6},
-	{0,7},	{1,7},	{2,7},	{3,7},	{4,7},	{5,7},	{6,7},	{7,7},	{8,7},	{9,7},
-	{0,8},	{1,8},	{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},	{8,8},	{9,8},
-	{0,9},	{1,9},	{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},	{8,9},	{9,9},
+static const unsigned char clock_icon[] = {
+	0xfc, 0x00,	/* ..######.. */
+	0x02, 0x01,	/* .#......#. */
+	0x11, 0x02,	/* #...#....# */
+	0x11, 0x02,	/* #...#....# */
+	0x11, 0x02,	/* #...#....# */
+	0xf1, 0x02,	/* #...####.# */
+	0x01, 0x02,	/* #........# */
+	0x01, 0x02,	/* #........# */
+	0x02, 0x01,	/* .#......#. */
+	0xfc, 0x00,	/* ..######.. */
 };
-*/
 
-static const XPoint clock_icon[] = {
-					{2,0},	{3,0},	{4,0},	{5,0},	{6,0},	{7,0},
-			{1,1},													{8,1},
-	{0,2},							{4,2},									{9,2},
-	{0,3},							{4,3},									{9,3},
-	{0,4},							{4,4},								 	{9,4},
-	{0,5},							{4,5},	{5,5},	{6,5},	{7,5},			{9,5},
-	{0,6},																	{9,6},
-	{0,7},																	{9,7},
-			{1,8},													{8,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
+static const unsigned char cpu_icon[] = {
+	0xb7, 0x03,	/* ###.##.### */
+	0xb7, 0x03,	/* ###.##.### */
+	0x03, 0x03,	/* ##......## */
+	0x78, 0x00,	/* ...####... */
+	0x7b, 0x03,	/* ##.####.## */
+	0x7b, 0x03,	/* ##.####.## */
+	0x78, 0x00,	/* ...####... */
+	0x03, 0x03,	/* ##......## */
+	0xb7, 0x03,	/* ###.##.### */
+	0xb7, 0x03,	/* ###.##.### */
 };
 
-static const XPoint cpu_icon[] = {
-	{0,0},	{1,0},	{2,0},			{4,0},	{5,0},			{7,0},	{8,0},	{9,0},
-	{0,1},	{1,1},	{2,1},			{4,1},	{5,1},			{7,1},	{8,1},	{9,1},
-	{0,2},	{1,2},													{8,2},	{9,2},
-							{3,3},	{4,3},	{5,3},	{6,3},
-	{0,4},	{1,4},			{3,4},	{4,4},	{5,4},	{6,4},			{8,4},	{9,4},
-	{0,5},	{1,5},			{3,5},	{4,5},	{5,5},	{6,5},			{8,5},	{9,5},
-							{3,6},	{4,6},	{5,6},	{6,6},
-	{0,7},	{1,7},													{8,7},	{9,7},
-	{0,8},	{1,8},	{2,8},			{4,8},	{5,8},			{7,8},	{8,8},	{9,8},
-	{0,9},	{1,9},	{2,9},			{4,9},	{5,9},			{7,9},	{8,9},	{9,9},
+static const unsigned char mem_icon[] = {
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0x00, 0x00,	/* .......... */
+	0xfe, 0x01,	/* .########. */
+	0xfe, 0x01,	/* .########. */
+	0xfe, 0x01,	/* .########. */
+	0xfe, 0x01,	/* .########. */
+	0x00, 0x00,	/* .......... */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
 };
 
-static const XPoint mem_icon[] = {
-			{1,0},	{2,0},			{4,0},	{5,0},			{7,0},	{8,0},
-			{1,1},	{2,1},			{4,1},	{5,1},			{7,1},	{8,1},
-
-			{1,3},	{2,3},	{3,3},	{4,3},	{5,3},	{6,3},	{7,3},	{8,3},
-			{1,4},	{2,4},	{3,4},	{4,4},	{5,4},	{6,4},	{7,4},	{8,4},
-			{1,5},	{2,5},	{3,5},	{4,5},	{5,5},	{6,5},	{7,5},	{8,5},
-			{1,6},	{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},	{8,6},
-
-			{1,8},	{2,8},			{4,8},	{5,8},			{7,8},	{8,8},
-			{1,9},	{2,9},			{4,9},	{5,9},			{7,9},	{8,9},
+static const unsigned char speaker_hi_icon[] = {
+	0x50, 0x00,	/* ....#.#... */
+	0x98, 0x00,	/* ...##..#.. */
+	0x1c, 0x01,	/* ..###...#. */
+	0x5f, 0x02,	/* #####.#..# */
+	0x9f, 0x02,	/* #####..#.# */
+	0x9f, 0x02,	/* #####..#.# */
+	0x5f, 0x02,	/* #####.#..# */
+	0x1c, 0x01,	/* ..###...#. */
+	0x98, 0x00,	/* ...##..#.. */
+	0x50, 0x00,	/* ....#.#... */
 };
 
-static const XPoint speaker_hi_icon[] = {
-									{4,0},			{6,0},
-							{3,1},	{4,1},					{7,1},
-					{2,2},	{3,2},	{4,2},							{8,2},
-	{0,3},	{1,3},	{2,3},	{3,3},	{4,3},			{6,3},					{9,3},
-	{0,4},	{1,4},	{2,4},	{3,4},	{4,4},					{7,4},			{9,4},
-	{0,5},	{1,5},	{2,5},	{3,5},	{4,5},					{7,5},			{9,5},
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},			{6,6},					{9,6},
-					{2,7},	{3,7},	{4,7},							{8,7},
-							{3,8},	{4,8},					{7,8},
-									{4,9},			{6,9},
+static const unsigned char speaker_mid_icon[] = {
+	0x10, 0x00,	/* ....#..... */
+	0x58, 0x00,	/* ...##.#... */
+	0x9c, 0x00,	/* ..###..#.. */
+	0x1f, 0x01,	/* #####...#. */
+	0x1f, 0x01,	/* #####...#. */
+	0x1f, 0x01,	/* #####...#. */
+	0x1f, 0x01,	/* #####...#. */
+	0x9c, 0x00,	/* ..###..#.. */
+	0x58, 0x00,	/* ...##.#... */
+	0x10, 0x00,	/* ....#..... */
 };
 
-static const XPoint speaker_mid_icon[] = {
-									{4,0},
-							{3,1},	{4,1},			{6,1},
-					{2,2},	{3,2},	{4,2},					{7,2},
-	{0,3},	{1,3},	{2,3},	{3,3},	{4,3},							{8,3},
-	{0,4},	{1,4},	{2,4},	{3,4},	{4,4},							{8,4},
-	{0,5},	{1,5},	{2,5},	{3,5},	{4,5},							{8,5},
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},							{8,6},
-					{2,7},	{3,7},	{4,7},					{7,7},
-							{3,8},	{4,8},			{6,8},
-									{4,9},			
+static const unsigned char speaker_low_icon[] = {
+	0x10, 0x00,	/* ....#..... */
+	0x18, 0x00,	/* ...##..... */
+	0x1c, 0x00,	/* ..###..... */
+	0x1f, 0x00,	/* #####..... */
+	0x1f, 0x00,	/* #####..... */
+	0x1f, 0x00,	/* #####..... */
+	0x1f, 0x00,	/* #####..... */
+	0x1c, 0x00,	/* ..###..... */
+	0x18, 0x00,	/* ...##..... */
+	0x10, 0x00,	/* ....#..... */
 };
 
-static const XPoint speaker_low_icon[] = {
-									{4,0},
-							{3,1},	{4,1},
-					{2,2},	{3,2},	{4,2},
-	{0,3},	{1,3},	{2,3},	{3,3},	{4,3},
-	{0,4},	{1,4},	{2,4},	{3,4},	{4,4},
-	{0,5},	{1,5},	{2,5},	{3,5},	{4,5},
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},
-					{2,7},	{3,7},	{4,7},
-							{3,8},	{4,8},
-									{4,9},			
+static const unsigned char speaker_mute_icon[] = {
+	0x20, 0x02,	/* .....#...# */
+	0x28, 0x02,	/* ...#.#...# */
+	0x5c, 0x01,	/* ..###.#.#. */
+	0x5f, 0x01,	/* #####.#.#. */
+	0x9f, 0x00,	/* #####..#.. */
+	0x9f, 0x00,	/* #####..#.. */
+	0x5f, 0x01,	/* #####.#.#. */
+	0x5c, 0x01,	/* ..###.#.#. */
+	0x28, 0x02,	/* ...#.#...# */
+	0x20, 0x02,	/* .....#...# */
 };
 
-static const XPoint speaker_mute_icon[] = {
-											{5,0},							{9,0},
-							{3,1},			{5,1},							{9,1},
-					{2,2},	{3,2},	{4,2},			{6,2},			{8,2},
-	{0,3},	{1,3},	{2,3},	{3,3},	{4,3},			{6,3},			{8,3},
-	{0,4},	{1,4},	{2,4},	{3,4},	{4,4},					{7,4},
-	{0,5},	{1,5},	{2,5},	{3,5},	{4,5},					{7,5},	
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},			{6,6},			{8,6},
-					{2,7},	{3,7},	{4,7},			{6,7},			{8,7},
-							{3,8},			{5,8},							{9,8},
-											{5,9},							{9,9},
+static const unsigned char wifi_full_icon[] = {
+	0x80, 0x01,	/* .......##. */
+	0x80, 0x01,	/* .......##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
 };
 
-static const XPoint wifi_full_icon[] = {
-															{7,0},	{8,0},
-															{7,1},	{8,1},
-									{4,2},	{5,2},			{7,2},	{8,2},
-									{4,3},	{5,3},			{7,3},	{8,3},
-			{1,4},	{2,4},			{4,4},	{5,4},			{7,4},	{8,4},
-			{1,5},	{2,5},			{4,5},	{5,5},			{7,5},	{8,5},
-			{1,6},	{2,6},			{4,6},	{5,6},			{7,6},	{8,6},
-			{1,7},	{2,7},			{4,7},	{5,7},			{7,7},	{8,7},
-			{1,8},	{2,8},			{4,8},	{5,8},			{7,8},	{8,8},
-			{1,9},	{2,9},			{4,9},	{5,9},			{7,9},	{8,9},
+static const unsigned char wifi_hi_icon[] = {
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x80, 0x01,	/* .......##. */
+	0x80, 0x01,	/* .......##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
 };
 
-static const XPoint wifi_hi_icon[] = {
-
-
-															{7,2},	{8,2},
-															{7,3},	{8,3},
-									{4,4},	{5,4},			{7,4},	{8,4},
-									{4,5},	{5,5},			{7,5},	{8,5},
-			{1,6},	{2,6},			{4,6},	{5,6},			{7,6},	{8,6},
-			{1,7},	{2,7},			{4,7},	{5,7},			{7,7},	{8,7},
-			{1,8},	{2,8},			{4,8},	{5,8},			{7,8},	{8,8},
-			{1,9},	{2,9},			{4,9},	{5,9},			{7,9},	{8,9},
+static const unsigned char wifi_mid_icon[] = {
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x80, 0x01,	/* .......##. */
+	0x80, 0x01,	/* .......##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb0, 0x01,	/* ....##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
+	0xb6, 0x01,	/* .##.##.##. */
 };
 
-static const XPoint wifi_mid_icon[] = {
-
-
-
-
-															{7,4},	{8,4},
-															{7,5},	{8,5},
-									{4,6},	{5,6},			{7,6},	{8,6},
-									{4,7},	{5,7},			{7,7},	{8,7},
-			{1,8},	{2,8},			{4,8},	{5,8},			{7,8},	{8,8},
-			{1,9},	{2,9},			{4,9},	{5,9},			{7,9},	{8,9},
+static const unsigned char wifi_low_icon[] = {
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x00, 0x00,	/* .......... */
+	0x30, 0x00,	/* ....##.... */
+	0x30, 0x00,	/* ....##.... */
+	0x36, 0x00,	/* .##.##.... */
+	0x36, 0x00,	/* .##.##.... */
 };
 
-static const XPoint wifi_low_icon[] = {
-
-
-
-
-													
-													
-									{4,6},	{5,6},	
-									{4,7},	{5,7},	
-			{1,8},	{2,8},			{4,8},	{5,8},	
-			{1,9},	{2,9},			{4,9},	{5,9},	
+static const unsigned char mail_new_icon[] = {
+	0xff, 0x03,	/* ########## */
+	0xfd, 0x02,	/* #.######.# */
+	0x79, 0x02,	/* #..####..# */
+	0x33, 0x03,	/* ##..##..## */
+	0x87, 0x03,	/* ###....### */
+	0xcf, 0x03,	/* ####..#### */
+	0xff, 0x03,	/* ########## */
+	0xff, 0x03,	/* ########## */
+	0xff, 0x03,	/* ########## */
+	0xff, 0x03,	/* ########## */
 };
 
-static const XPoint mail_new_icon[] = {
-	{0,0},	{1,0},	{2,0},	{3,0},	{4,0},	{5,0},	{6,0},	{7,0},	{8,0},	{9,0},
-	{0,1},			{2,1},	{3,1},	{4,1},	{5,1},	{6,1},	{7,1},			{9,1},
-	{0,2},					{3,2},	{4,2},	{5,2},	{6,2},					{9,2},
-	{0,3},	{1,3},					{4,3},	{5,3},					{8,3},	{9,3},
-	{0,4},	{1,4},	{2,4},									{7,4},	{8,4},	{9,4},
-	{0,5},	{1,5},	{2,5},	{3,5},					{6,5},	{7,5},	{8,5},	{9,5},
-	{0,6},	{1,6},	{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},	{8,6},	{9,6},
-	{0,7},	{1,7},	{2,7},	{3,7},	{4,7},	{5,7},	{6,7},	{7,7},	{8,7},	{9,7},
-	{0,8},	{1,8},	{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},	{8,8},	{9,8},
-	{0,9},	{1,9},	{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},	{8,9},	{9,9},
+static const unsigned char mail_none_icon[] = {
+	0xff, 0x03,	/* ########## */
+	0x01, 0x02,	/* #........# */
+	0x01, 0x02,	/* #........# */
+	0x85, 0x02,	/* #.#....#.# */
+	0x49, 0x02,	/* #..#..#..# */
+	0x31, 0x02,	/* #...##...# */
+	0x01, 0x02,	/* #........# */
+	0x01, 0x02,	/* #........# */
+	0x01, 0x02,	/* #........# */
+	0xff, 0x03,	/* ########## */
 };
 
-static const XPoint mail_none_icon[] = {
-	{0,0},	{1,0},	{2,0},	{3,0},	{4,0},	{5,0},	{6,0},	{7,0},	{8,0},	{9,0},
-	{0,1},																	{9,1},
-	{0,2},																	{9,2},
-	{0,3},			{2,3},									{7,3},			{9,3},
-	{0,4},					{3,4},					{6,4},					{9,4},
-	{0,5},							{4,5},	{5,5},							{9,5},
-	{0,6},																	{9,6},
-	{0,7},																	{9,7},
-	{0,8},																	{9,8},
-	{0,9},	{1,9},	{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},	{8,9},	{9,9},
+static const unsigned char batt_full_icon[] = {
+	0x30, 0x00,	/* ....##.... */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
 };
 
-static const XPoint batt_full_icon[] = {
-									{4,0},	{5,0},
-					{2,1},	{3,1},	{4,1},	{5,1},	{6,1},	{7,1},
-					{2,2},	{3,2},	{4,2},	{5,2},	{6,2},	{7,2},
-					{2,3},	{3,3},	{4,3},	{5,3},	{6,3},	{7,3},
-					{2,4},	{3,4},	{4,4},	{5,4},	{6,4},	{7,4},
-					{2,5},	{3,5},	{4,5},	{5,5},	{6,5},	{7,5},
-					{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},
-					{2,7},	{3,7},	{4,7},	{5,7},	{6,7},	{7,7},
-					{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
+static const unsigned char batt_hi_icon[] = {
+	0x30, 0x00,	/* ....##.... */
+	0xcc, 0x00,	/* ..##..##.. */
+	0xc4, 0x00,	/* ..#...##.. */
+	0xf4, 0x00,	/* ..#.####.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
 };
 
-static const XPoint batt_hi_icon[] = {
-									{4,0},	{5,0},
-					{2,1},	{3,1},					{6,1},	{7,1},
-					{2,2},							{6,2},	{7,2},
-					{2,3},			{4,3},	{5,3},	{6,3},	{7,3},
-					{2,4},	{3,4},	{4,4},	{5,4},	{6,4},	{7,4},
-					{2,5},	{3,5},	{4,5},	{5,5},	{6,5},	{7,5},
-					{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},
-					{2,7},	{3,7},	{4,7},	{5,7},	{6,7},	{7,7},
-					{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
+static const unsigned char batt_mid_icon[] = {
+	0x30, 0x00,	/* ....##.... */
+	0xcc, 0x00,	/* ..##..##.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0xc4, 0x00,	/* ..#...##.. */
+	0xf4, 0x00,	/* ..#.####.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
 };
 
-static const XPoint batt_mid_icon[] = {
-									{4,0},	{5,0},
-					{2,1},	{3,1},					{6,1},	{7,1},
-					{2,2},									{7,2},
-					{2,3},									{7,3},
-					{2,4},							{6,4},	{7,4},
-					{2,5},			{4,5},	{5,5},	{6,5},	{7,5},
-					{2,6},	{3,6},	{4,6},	{5,6},	{6,6},	{7,6},
-					{2,7},	{3,7},	{4,7},	{5,7},	{6,7},	{7,7},
-					{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
+static const unsigned char batt_low_icon[] = {
+	0x30, 0x00,	/* ....##.... */
+	0xcc, 0x00,	/* ..##..##.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0xc4, 0x00,	/* ..#...##.. */
+	0xf4, 0x00,	/* ..#.####.. */
+	0xfc, 0x00,	/* ..######.. */
+	0xfc, 0x00,	/* ..######.. */
 };
 
-static const XPoint batt_low_icon[] = {
-									{4,0},	{5,0},
-					{2,1},	{3,1},					{6,1},	{7,1},
-					{2,2},									{7,2},
-					{2,3},									{7,3},
-					{2,4},									{7,4},
-					{2,5},									{7,5},
-					{2,6},							{6,6},	{7,6},
-					{2,7},			{4,7},	{5,7},	{6,7},	{7,7},
-					{2,8},	{3,8},	{4,8},	{5,8},	{6,8},	{7,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
+static const unsigned char batt_zero_icon[] = {
+	0x30, 0x00,	/* ....##.... */
+	0xcc, 0x00,	/* ..##..##.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0x84, 0x00,	/* ..#....#.. */
+	0xfc, 0x00,	/* ..######.. */
 };
 
-static const XPoint batt_zero_icon[] = {
-									{4,0},	{5,0},
-					{2,1},	{3,1},					{6,1},	{7,1},
-					{2,2},									{7,2},
-					{2,3},									{7,3},
-					{2,4},									{7,4},
-					{2,5},									{7,5},
-					{2,6},									{7,6},
-					{2,7},									{7,7},
-					{2,8},									{7,8},
-					{2,9},	{3,9},	{4,9},	{5,9},	{6,9},	{7,9},
-};
-
-static const XPoint batt_charge_icon[] = {
-													{6,0},	{7,0},
-											{5,1},	{6,1},
-									{4,2},	{5,2},	
-							{3,3},	{4,3},		
-					{2,4},	{3,4},	{4,4},	{5,4},	{6,4},	{7,4},	{8,4},
-			{1,5},	{2,5},	{3,5},	{4,5},	{5,5},	{6,5},	{7,5},
-											{5,6},	{6,6},
-									{4,7},	{5,7},
-							{3,8},	{4,8},
-					{2,9},	{3,9},
+static const unsigned char batt_charge_icon[] = {
+	0xc0, 0x00,	/* ......##.. */
+	0x60, 0x00,	/* .....##... */
+	0x30, 0x00,	/* ....##.... */
+	0x18, 0x00,	/* ...##..... */
+	0xfc, 0x01,	/* ..#######. */
+	0xfe, 0x00,	/* .#######.. */
+	0x60, 0x00,	/* .....##... */
+	0x30, 0x00,	/* ....##.... */
+	0x18, 0x00,	/* ...##..... */
+	0x0c, 0x00,	/* ..##...... */
 };
 
 static const Icon icons[] = {
@@ -300,5 +284,3 @@ static const Icon icons[] = {
 
 // vim: ts=4
 #endif /* __SCWM_ICONS_H__ */
-
-
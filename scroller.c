@@ -10,8 +10,9 @@
 * - VOL: blue > grey > yellow > red (with different icons)
 * - BAT: green > grey > yellow > red (with different icons)
 * - WIFI: green > grey > yellow > red (with different icons)
-* - MAIL: green = most recent mail is new, blue = new mail exists,
-*         grey = no new mail
+* - MAIL: one icon per maildir with its unread count,
+*         green = most recent mail is new, blue = unread mail exists,
+*         grey = no unread mail
 * - CLOCK: red = appointment within 20 minutes,
 *          yellow = appontment within 2 hours,
 *          green = appointment later today,
@@ -31,6 +32,11 @@
 *   $ sed -i 's/jmcclure/'$USER'/' scroller.c
 *   $ gcc -o scroller scroller.c
 *
+* OUTPUT:
+*   When started by scrollwm with a shared memory status channel
+*   (see shmstatus.h) segments are written there directly;
+*   otherwise, or with -t, colour and icon tokens are printed.
+*
 * NOTE:
 *   To use this status input you must compile scrollwm with
 *   the #include "icons.h" line uncommented in the config.h
@@ -43,20 +49,18 @@
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/inotify.h>
+#include <limits.h>
 #include <dirent.h>
 #include <time.h>
+#include "shmstatus.h"
 
 /* input files */
-static const char *CPU_FILE		= "/proc/stat";
-static const char *MEM_FILE		= "/proc/meminfo";
-static const char *AUD_FILE		= "/proc/asound/card0/codec#0";
-static const char *WIFI_FILE	= "/proc/net/wireless";
-static const char *BATT_NOW		= "/sys/class/power_supply/BAT1/charge_now";
-static const char *BATT_FULL	= "/sys/class/power_supply/BAT1/charge_full";
-static const char *BATT_STAT	= "/sys/class/power_supply/BAT1/status";
-static const char *MAIL_CUR		= "/home/jmcclure/mail/INBOX/cur";
-static const char *MAIL_NEW		= "/home/jmcclure/mail/INBOX/new";
+static const char *MAILDIRS[]	= { "/home/jmcclure/mail/INBOX", NULL };
+static const char *REM_FILE		= "/home/jmcclure/.reminders";
 static const char *REM_CMD		= "rem -naa -b1 | sort";
 
 /* colors			  			    R G B */
@@ -77,145 +81,385 @@ enum {
 	batt_charge_icon,
 };
 
+/* input files stay open and are re-read with pread into fixed buffers */
+typedef struct {
+	const char *path;
+	int fd;
+	char buf[512];
+} Input;
+
+static Input cpu_in		= { "/proc/stat", -1 };
+static Input mem_in		= { "/proc/meminfo", -1 };
+static Input aud_in		= { "/proc/asound/card0/codec#0", -1 };
+static Input wifi_in	= { "/proc/net/wireless", -1 };
+static Input bnow_in	= { "/sys/class/power_supply/BAT1/charge_now", -1 };
+static Input bfull_in	= { "/sys/class/power_supply/BAT1/charge_full", -1 };
+static Input bstat_in	= { "/sys/class/power_supply/BAT1/status", -1 };
+
 /* variables */
 static long		j1,j2,j3,j4,ln1,ln2,ln3,ln4;
-static int		n, loops = 0, mail = 0;
-static char		c, clk[8], *aud_file, *mail_file;
-static FILE		*in;
+static int		n, loops = 0;
+static char		c, clk[12];
 static time_t	current;
+static int		aud_hint[2] = { -1, -1 };	/* first Amp-Out caps, Node 0x14 */
+static int		mem_hint[4] = { -1, -1, -1, -1 };
 
-static int mailcheck() {
-	DIR *dir;
+/* maildir state kept up to date from inotify; index 0 is cur, 1 is new */
+typedef struct {
+	const char *path;
+	int wd[2];
+	int unread[2];
+	time_t newest[2];	/* high-water marks: removals never lower them, only a
+				 * full scan does, or new running empty for newest[1] */
+} Maildir;
+
+static Maildir	maildir[8];
+static int		nmaildirs = 0, mail_fd = -1;
+/* today's timed reminders, reloaded when the reminders file or the day changes */
+static time_t	event[64];
+static int		nevents = 0, event_day = -1, rem_fd = -1, rem_wd = -1;
+static const char	*rem_name;
+static ShmStatus	*shm = NULL;
+static ShmSnapshot	*snap;
+static int		doorbell = -1;
+
+/* one status segment: printed as tokens, or filled into the snapshot */
+static void seg(long color, int icon, const char *text) {
+	ShmSegment *s;
+	if (!shm) {
+		printf("{#%06lX}",color);
+		if (icon >= 0) printf("{i %d}",icon);
+		if (text) printf("%s",text);
+		return;
+	}
+	if (snap->n >= SHMSTATUS_SEGS) return;
+	s = &snap->seg[snap->n++];
+	s->rgb = color; s->icon = icon;
+	strncpy(s->text,(text ? text : ""),SHMSTATUS_TEXT-1);
+	s->text[SHMSTATUS_TEXT-1] = '\0';
+}
+
+/* end of a status line: publish the snapshot and ring the doorbell */
+static void publish() {
+	uint64_t one = 1;
+	if (!shm) {
+		printf("\n");
+		fflush(stdout);
+		return;
+	}
+	__atomic_store_n(&shm->head,shm->head+1,__ATOMIC_RELEASE);
+	write(doorbell,&one,sizeof(one));
+	snap = &shm->slot[shm->head % SHMSTATUS_SLOTS];
+	snap->n = 0;
+}
+
+static void shmsetup() {
+	const char *m = getenv("SCROLLWM_STATUS_SHM"), *d = getenv("SCROLLWM_STATUS_FD");
+	if (!m || !d) return;
+	shm = mmap(NULL,sizeof(ShmStatus),PROT_READ|PROT_WRITE,MAP_SHARED,atoi(m),0);
+	if (shm == MAP_FAILED || shm->magic != SHMSTATUS_MAGIC) {
+		shm = NULL;
+		return;
+	}
+	doorbell = atoi(d);
+	snap = &shm->slot[shm->head % SHMSTATUS_SLOTS];
+	snap->n = 0;
+}
+
+static int input_read(Input *in, off_t off) {
+	int n;
+	if (in->fd < 0 && (in->fd=open(in->path,O_RDONLY | O_CLOEXEC)) < 0) return -1;
+	if ((n=pread(in->fd,in->buf,sizeof(in->buf)-1,off)) < 0) {
+		close(in->fd);
+		in->fd = -1;
+		return -1;
+	}
+	in->buf[n] = '\0';
+	return n;
+}
+
+/* number after p, in the given base; p is left past it */
+static long number(const char **p, int base) {
+	const char *s = *p;
+	long v = 0;
+	int d;
+	while (*s && !(*s >= '0' && *s <= '9')) s++;
+	for (;; s++) {
+		if (*s >= '0' && *s <= '9') d = *s - '0';
+		else if (base == 16 && (*s|0x20) >= 'a' && (*s|0x20) <= 'f') d = (*s|0x20) - 'a' + 10;
+		else break;
+		v = v * base + d;
+	}
+	*p = s;
+	return v;
+}
+
+/* "key" in the first len bytes of buf: looked for first where it was last time */
+static const char *find(const char *buf, int len, const char *key, int *hint) {
+	const char *p;
+	int l = strlen(key);
+	if (*hint >= 0 && *hint <= len - l && !strncmp(buf + *hint,key,l))
+		return buf + *hint;
+	if ((p=strstr(buf,key))) *hint = p - buf;
+	return p;
+}
+
+/* value of "key" in the first len bytes of the buffer */
+static long field(Input *in, int len, const char *key, int *hint) {
+	const char *p;
+	if (!(p=find(in->buf,len,key,hint))) return 0;
+	p += strlen(key);
+	return number(&p,10);
+}
+
+/* the codec dump is regenerated whenever it is read from anywhere but
+ * where the last read stopped, so it is read once a tick from the start;
+ * its fields are then looked for where they were last time */
+static int audio(long *caps, long *vals, long *mute) {
+	static char big[1<<16];
+	const char *p;
+	int n;
+	if (aud_in.fd < 0 && (aud_in.fd=open(aud_in.path,O_RDONLY | O_CLOEXEC)) < 0) return -1;
+	if ((n=pread(aud_in.fd,big,sizeof(big)-1,0)) <= 0) {
+		close(aud_in.fd);
+		aud_in.fd = -1;
+		return -1;
+	}
+	big[n] = '\0';
+	if (!(p=find(big,n,"Amp-Out caps: ofs=0x",&aud_hint[0]))) return -1;
+	p += 20; *caps = number(&p,16);
+	if (!(p=strstr(p,"Amp-Out vals:")) || !(p=strstr(p,"[0x"))) return -1;
+	p += 3; *vals = number(&p,16);
+	if (!(p=find(big,n,"Node 0x14 [",&aud_hint[1]))) return -1;
+	if (!(p=strstr(p,"Amp-Out vals:")) || !(p=strstr(p,"[0x"))) return -1;
+	p += 3; *mute = number(&p,16);
+	return 0;
+}
+
+/* everything in new is unread; in cur, mail without the Seen flag */
+static void mail_update(Maildir *m, int sub, const char *name, int sign) {
+	char path[PATH_MAX], *end;
+	const char *info;
+	struct stat st;
+	time_t t;
+	if (name[0] == '.') return;
+	if (sub == 1 || !(info=strstr(name,":2,")) || !strchr(info+3,'S'))
+		m->unread[sub] += sign;
+	if (sign > 0) {
+		/* the delivery time leads a maildir name; stat only odd names */
+		t = strtol(name,&end,10);
+		if (end == name || *end != '.')
+			t = (snprintf(path,sizeof(path),"%s/%s/%s",m->path,(sub ? "new" : "cur"),
+					name) < sizeof(path) && !stat(path,&st) ? st.st_mtime : 0);
+		if (t > m->newest[sub]) m->newest[sub] = t;
+	}
+	if (m->unread[sub] <= 0) {
+		m->unread[sub] = 0;
+		if (sub == 1) m->newest[1] = 0;
+	}
+}
+
+/* the one full scan, at startup or after the event queue overflowed */
+static void mail_scan(Maildir *m) {
+	char path[PATH_MAX];
 	struct dirent *de;
-	struct stat info;
-	time_t cur,new;
-	char *dname;
-	chdir(MAIL_CUR);
-	if ( !(dir=opendir(MAIL_CUR)) ) return 0;
-	while ( (de=readdir(dir)) ) dname = de->d_name;
-	if (dname[0] == '.') { closedir(dir); return 0; }
-	stat(dname,&info);
-	cur = info.st_mtime;
-	closedir(dir);
-	chdir(MAIL_NEW);
-	if ( !(dir=opendir(MAIL_NEW)) ) return -1;
-	while ( (de=readdir(dir)) ) dname = de->d_name;
-	if (dname[0] == '.') { closedir(dir); return 0; }
-	stat(dname,&info);
-	new = info.st_mtime;
-	closedir(dir);
-	if (new > cur) return 2;
-	else return 1;
+	DIR *dir;
+	int sub;
+	for (sub = 0; sub < 2; sub++) {
+		m->unread[sub] = 0;
+		m->newest[sub] = 0;
+		snprintf(path,sizeof(path),"%s/%s",m->path,(sub ? "new" : "cur"));
+		if (m->wd[sub] < 0 && mail_fd >= 0)
+			m->wd[sub] = inotify_add_watch(mail_fd,path,
+					IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO);
+		if (!(dir=opendir(path))) continue;
+		while ((de=readdir(dir))) mail_update(m,sub,de->d_name,1);
+		closedir(dir);
+	}
 }
 
-static long schedulecheck() {
+static void mail_init() {
+	mail_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	for (nmaildirs = 0; MAILDIRS[nmaildirs] && nmaildirs < 8; nmaildirs++) {
+		maildir[nmaildirs].path = MAILDIRS[nmaildirs];
+		maildir[nmaildirs].wd[0] = maildir[nmaildirs].wd[1] = -1;
+		mail_scan(&maildir[nmaildirs]);
+	}
+}
+
+/* apply whatever changed since the last tick: one read when idle */
+static void mail_events() {
+	char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *ev;
+	char *p;
+	int i, sub, n;
+	if (mail_fd < 0) return;
+	while ((n=read(mail_fd,buf,sizeof(buf))) > 0)
+		for (p = buf; p < buf + n; p += sizeof(*ev) + ev->len) {
+			ev = (const struct inotify_event *) p;
+			if (ev->mask & IN_Q_OVERFLOW) {
+				for (i = 0; i < nmaildirs; i++) mail_scan(&maildir[i]);
+				continue;
+			}
+			if (!ev->len) continue;
+			for (i = 0; i < nmaildirs; i++) for (sub = 0; sub < 2; sub++)
+				if (maildir[i].wd[sub] == ev->wd)
+					mail_update(&maildir[i],sub,ev->name,
+							(ev->mask & (IN_CREATE | IN_MOVED_TO) ? 1 : -1));
+		}
+}
+
+/* the one place rem is run: keep today's timed events, read to EOF */
+static void schedule_load() {
 	FILE *in;
-	if ( !(in=popen(REM_CMD,"r")) ) return 0;
-	int y,m,d,hh=-1,mm;
-	time_t c,t = time(NULL);
-	struct tm *tmp = localtime(&t);
-	while (fscanf(in,"%d/%d/%d %d:%d",&y,&m,&d,&hh,&mm) != 5)
-		fscanf(in,"%*[^\n]\n");
+	char line[256];
+	int y,m,d,hh,mm;
+	time_t t = time(NULL);
+	struct tm today = *localtime(&t), tm;
+	nevents = 0;
+	event_day = today.tm_yday;
+	if ( !(in=popen(REM_CMD,"r")) ) return;
+	while (fgets(line,sizeof(line),in)) {
+		if (sscanf(line,"%d/%d/%d %d:%d",&y,&m,&d,&hh,&mm) != 5) continue;
+		if (y != today.tm_year+1900 || m != today.tm_mon+1 || d != today.tm_mday) continue;
+		if (nevents == sizeof(event)/sizeof(event[0])) continue;
+		tm = today;
+		tm.tm_hour=hh; tm.tm_min=mm; tm.tm_sec=0; tm.tm_isdst=-1;
+		event[nevents++] = mktime(&tm);
+	}
 	pclose(in);
-	tmp->tm_year=y-1900; tmp->tm_mon=m-1; tmp->tm_mday=d;
-	c = mktime(tmp);
-	if (c != t) return Blue; /* nothing left today */
-	tmp->tm_hour=hh; tmp->tm_min=mm;
-	c = mktime(tmp);
+}
+
+/* watch the directory: editors usually replace the file rather than write it */
+static void schedule_init() {
+	char dir[PATH_MAX];
+	const char *slash = strrchr(REM_FILE,'/');
+	rem_name = (slash ? slash + 1 : REM_FILE);
+	snprintf(dir,sizeof(dir),"%.*s",(slash ? (int)(slash - REM_FILE) : 1),
+			(slash ? REM_FILE : "."));
+	if ((rem_fd=inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) >= 0)
+		rem_wd = inotify_add_watch(rem_fd,(dir[0] ? dir : "/"),
+				IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+	schedule_load();
+}
+
+/* colour of the clock from the cache; rem only runs if something changed */
+static long schedulecheck() {
+	char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *ev;
+	char *p;
+	int i, n, reload = 0;
+	time_t t = time(NULL), c = 0;
+	if (rem_fd >= 0) while ((n=read(rem_fd,buf,sizeof(buf))) > 0)
+		for (p = buf; p < buf + n; p += sizeof(*ev) + ev->len) {
+			ev = (const struct inotify_event *) p;
+			if ((ev->mask & IN_Q_OVERFLOW) || (ev->wd == rem_wd &&
+					ev->len && !strcmp(ev->name,rem_name)))
+				reload = 1;
+		}
+	if (reload || localtime(&t)->tm_yday != event_day) schedule_load();
+	for (i = 0; i < nevents; i++)
+		if (event[i] >= t && (!c || event[i] < c)) c = event[i];
+	if (!c) return Blue; /* nothing left today */
 	if (c < t + 1200) return Red; /* next event within 20 minutes */
 	if (c < t + 7200) return Yellow; /* next event within 2 hours */
 	return Green; /* event later today */
 }
 
 int main(int argc, const char **argv) {
-	in = fopen(CPU_FILE,"r");
-	fscanf(in,"cpu %ld %ld %ld %ld",&j1,&j2,&j3,&j4);
-	fclose(in);
-	long clock_color = schedulecheck();
+	if (argc < 2 || strcmp(argv[1],"-t")) shmsetup();
+	const char *p;
+	char num[16];
+	Maildir *m;
+	int i;
+	mail_init();
+	schedule_init();
+	if (input_read(&cpu_in,0) > 0) {
+		p = cpu_in.buf;
+		j1 = number(&p,10); j2 = number(&p,10); j3 = number(&p,10); j4 = number(&p,10);
+	}
 	/* main loop */
 	for (;;) {
-		if ( (in=fopen(CPU_FILE,"r")) ) {       /* CPU MONITOR */
-			fscanf(in,"cpu %ld %ld %ld %ld",&ln1,&ln2,&ln3,&ln4);
-			fclose(in);
+		if (input_read(&cpu_in,0) > 0) {		/* CPU MONITOR */
+			p = cpu_in.buf;
+			ln1 = number(&p,10); ln2 = number(&p,10); ln3 = number(&p,10); ln4 = number(&p,10);
 			if (ln4>j4) n=(int)100*(ln1-j1+ln2-j2+ln3-j3)/(ln1-j1+ln2-j2+ln3-j3+ln4-j4);
 			else n=0;
 			j1=ln1; j2=ln2; j3=ln3; j4=ln4;
-			if (n > 85) printf("{#%06X}{i %d} ",Red,cpu_icon);
-			else if (n > 60) printf("{#%06X}{i %d} ",Yellow,cpu_icon);
-			else if (n > 20) printf("{#%06X}{i %d} ",Blue,cpu_icon);
-			else printf("{#%06X}{i %d} ",Grey,cpu_icon);
+			if (n > 85) seg(Red,cpu_icon," ");
+			else if (n > 60) seg(Yellow,cpu_icon," ");
+			else if (n > 20) seg(Blue,cpu_icon," ");
+			else seg(Grey,cpu_icon," ");
 		}
-		if ( (in=fopen(MEM_FILE,"r")) ) {		/* MEM USAGE MONITOR */
-			fscanf(in,"MemTotal: %ld kB\nMemFree: %ld kB\nBuffers: %ld kB\nCached: %ld kB\n", &ln1,&ln2,&ln3,&ln4);
-			fclose(in);
-			n = 100*(ln2+ln3+ln4)/ln1;
-			if (n > 80) printf("{#%06X}{i %d} ",Grey,mem_icon);
-			else if (n > 65) printf("{#%06X}{i %d} ",Green,mem_icon);
-			else if (n > 15) printf("{#%06X}{i %d} ",Yellow,mem_icon);
-			else printf("{#%06X}{i %d} ",Red,mem_icon);
+		if ((n=input_read(&mem_in,0)) > 0) {		/* MEM USAGE MONITOR */
+			ln1 = field(&mem_in,n,"MemTotal:",&mem_hint[0]);
+			ln2 = field(&mem_in,n,"MemFree:",&mem_hint[1]);
+			ln3 = field(&mem_in,n,"Buffers:",&mem_hint[2]);
+			ln4 = field(&mem_in,n,"Cached:",&mem_hint[3]);
+			n = (ln1 ? 100*(ln2+ln3+ln4)/ln1 : 0);
+			if (n > 80) seg(Grey,mem_icon," ");
+			else if (n > 65) seg(Green,mem_icon," ");
+			else if (n > 15) seg(Yellow,mem_icon," ");
+			else seg(Red,mem_icon," ");
 		}
-		if ( (in=fopen(AUD_FILE,"r")) ) {       /* AUDIO VOLUME MONITOR */
-			while ( fscanf(in," Amp-Out caps: ofs=0x%x",&ln1) !=1 )
-				fscanf(in,"%*[^\n]\n");
-			while ( fscanf(in," Amp-Out vals: [0x%x",&ln2) != 1 )
-				fscanf(in,"%*[^\n]\n");
-			while ( fscanf(in,"Node 0x14 [%c",&c) != 1 )
-				fscanf(in,"%*[^\n]\n");
-			while ( fscanf(in," Amp-Out vals: [0x%x",&ln3) != 1 )
-				fscanf(in,"%*[^\n]\n");
-			fclose(in);
-			if (ln3 != 0) printf("{#%06X}{i %d} ",Red,speaker_mute_icon);
+		if (audio(&ln1,&ln2,&ln3) == 0) {		/* AUDIO VOLUME MONITOR */
+			if (ln3 != 0) seg(Red,speaker_mute_icon," ");
 			else {
-				n = 100*ln2/ln1;
-				if (n > 95) printf("{#%06X}{i %d} ",Blue,speaker_hi_icon);
-				else if (n > 75) printf("{#%06X}{i %d} ",Grey,speaker_hi_icon);
-				else if (n > 50) printf("{#%06X}{i %d} ",Grey,speaker_mid_icon);
-				else if (n > 30) printf("{#%06X}{i %d} ",Yellow,speaker_mid_icon);
-				else if (n > 10) printf("{#%06X}{i %d} ",Yellow,speaker_low_icon);
-				else printf("{#%06X}{i %d} ",Red,speaker_low_icon);
+				n = (ln1 ? 100*ln2/ln1 : 0);
+				if (n > 95) seg(Blue,speaker_hi_icon," ");
+				else if (n > 75) seg(Grey,speaker_hi_icon," ");
+				else if (n > 50) seg(Grey,speaker_mid_icon," ");
+				else if (n > 30) seg(Yellow,speaker_mid_icon," ");
+				else if (n > 10) seg(Yellow,speaker_low_icon," ");
+				else seg(Red,speaker_low_icon," ");
 			}
 		}
-		if ( (in=fopen(BATT_NOW,"r")) ) {       /* BATTERY MONITOR */
-			fscanf(in,"%ld\n",&ln1); fclose(in);
-			if ( (in=fopen(BATT_FULL,"r")) ) { fscanf(in,"%ld\n",&ln2); fclose(in); }
-			if ( (in=fopen(BATT_STAT,"r")) ) { fscanf(in,"%c",&c); fclose(in); }
-			n = (ln1 ? ln1 * 100 / ln2 : 0);
-			if (c == 'C') printf("{#%06X}{i %d} ",Yellow,batt_charge_icon);
-			else if (n > 95) printf("{#%06X}{i %d} ",Green,batt_full_icon);
-			else if (n > 90) printf("{#%06X}{i %d} ",Blue,batt_full_icon);
-			else if (n > 85) printf("{#%06X}{i %d} ",Grey,batt_full_icon);
-			else if (n > 70) printf("{#%06X}{i %d} ",Grey,batt_hi_icon);
-			else if (n > 40) printf("{#%06X}{i %d} ",Grey,batt_mid_icon);
-			else if (n > 20) printf("{#%06X}{i %d} ",Grey,batt_low_icon);
-			else if (n > 15) printf("{#%06X}{i %d} ",Yellow,batt_low_icon);
-			else if (n > 8) printf("{#%06X}{i %d} ",Yellow,batt_zero_icon);
-			else printf("{#%06X}{i %d} ",Red,batt_zero_icon);
+		if (input_read(&bnow_in,0) > 0) {		/* BATTERY MONITOR */
+			p = bnow_in.buf; ln1 = number(&p,10);
+			if (input_read(&bfull_in,0) > 0) { p = bfull_in.buf; ln2 = number(&p,10); }
+			if (input_read(&bstat_in,0) > 0) c = bstat_in.buf[0];
+			n = (ln1 && ln2 ? ln1 * 100 / ln2 : 0);
+			if (c == 'C') seg(Yellow,batt_charge_icon," ");
+			else if (n > 95) seg(Green,batt_full_icon," ");
+			else if (n > 90) seg(Blue,batt_full_icon," ");
+			else if (n > 85) seg(Grey,batt_full_icon," ");
+			else if (n > 70) seg(Grey,batt_hi_icon," ");
+			else if (n > 40) seg(Grey,batt_mid_icon," ");
+			else if (n > 20) seg(Grey,batt_low_icon," ");
+			else if (n > 15) seg(Yellow,batt_low_icon," ");
+			else if (n > 8) seg(Yellow,batt_zero_icon," ");
+			else seg(Red,batt_zero_icon," ");
 		}
-		if ( (in=fopen(WIFI_FILE,"r")) ) {       /* WIFI MONITOR */
+		if (input_read(&wifi_in,0) > 0) {		/* WIFI MONITOR */
 			n = 0;
-			fscanf(in,"%*[^\n]\n%*[^\n]\n wlan0: %*d %d.",&n);
-			fclose(in);
-			if (n == 0) printf("{#%06X}{i %d} ",Red,wifi_low_icon);
-			else if (n > 63) printf("{#%06X}{i %d} ",Green,wifi_full_icon);
-			else if (n > 61) printf("{#%06X}{i %d} ",Grey,wifi_full_icon);
-			else if (n > 56) printf("{#%06X}{i %d} ",Grey,wifi_mid_icon);
-			else if (n > 51) printf("{#%06X}{i %d} ",Grey,wifi_low_icon);
-			else printf("{#%06X}{i %d} ",Yellow,wifi_low_icon);
+			if ((p=strstr(wifi_in.buf,"wlan0:"))) {
+				p += 6; number(&p,10); n = number(&p,10);
+			}
+			if (n == 0) seg(Red,wifi_low_icon," ");
+			else if (n > 63) seg(Green,wifi_full_icon," ");
+			else if (n > 61) seg(Grey,wifi_full_icon," ");
+			else if (n > 56) seg(Grey,wifi_mid_icon," ");
+			else if (n > 51) seg(Grey,wifi_low_icon," ");
+			else seg(Yellow,wifi_low_icon," ");
+		}
+		mail_events();								/* MAIL */
+		for (i = 0; i < nmaildirs; i++) {
+			m = &maildir[i];
+			n = m->unread[0] + m->unread[1];
+			snprintf(num,sizeof(num)," %d ",n);
+			if (m->unread[1] && m->newest[1] >= m->newest[0]) seg(Green,mail_new_icon,num);
+			else if (n) seg(Blue,mail_new_icon,num);
+			else seg(Grey,mail_none_icon," ");
 		}
-		if ((loops % 10) == 0) mail = mailcheck();    /* MAIL */
-			if (mail == 1) printf("{#%06X}{i %d} ",Blue,mail_new_icon);
-			else if (mail == 2) printf("{#%06X}{i %d} ",Green,mail_new_icon);
-			else printf("{#%06X}{i %d} ",Grey,mail_none_icon);
 		if ((loops % 40) == 0) {					/* TIME */
 			time(&current);
-			strftime(clk,6,"%H:%M",localtime(&current));
+			strftime(clk,8," %H:%M ",localtime(&current));
 		}
-		if (loops++ > 120) {
-			clock_color = schedulecheck();
-			loops = 0;
-		}	
-		printf(" {#%06X}{i %d}{#%06X} %s \n",clock_color,clock_icon,White,clk);
-		fflush(stdout);
+		loops++;
+		seg(White,-1," ");
+		seg(schedulecheck(),clock_icon,NULL);
+		seg(White,-1,clk);
+		publish();
 		sleep(1);
 	}
 	return 0;
@@ -13,14 +13,27 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 #include <X11/Xlib.h>
 #include <X11/keysym.h>
 #include <X11/XKBlib.h>
 #include <X11/Xatom.h>
 #include <X11/Xutil.h>
 #include <X11/cursorfont.h>
+#include <X11/extensions/Xcomposite.h>
+#include <X11/extensions/Xrender.h>
+#include <X11/extensions/sync.h>
+#include "shmstatus.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define ROUND(v)  ((int) ((v) < 0 ? (v) - 0.5 : (v) + 0.5))
 
 #define SCWM_FLOATING	0x0001
 #define SCWM_TRANSIENT	0x0003
@@ -28,8 +41,36 @@
 #define SCWM_TILED		0xFF00
 #define SCWM_ANY		0xFFFF
 
+#define WINHASH			256
+#define WINHASH_KEY(w)	(((w) ^ ((w) >> 16)) & (WINHASH-1))
+#define CX(c)			geom.x[(c)->id]
+#define CY(c)			geom.y[(c)->id]
+#define CW(c)			geom.w[(c)->id]
+#define CH(c)			geom.h[(c)->id]
+#define CTAGS(c)		geom.tags[(c)->id]
+#define CFLAGS(c)		geom.flags[(c)->id]
+
+#define POOL_SLAB		32
+#define TITLE_MAX		512
+
+#define HEXCACHE		32
+#define CANVAS			8192
+#define STATUS_TEXT		512
+#define STATUS_OPS		64
+#define EVBATCH			64
+#define STATUS_RING		4096
+#define STATUS_SOURCES	8
+
+#define GRIDHASH		64
+#define GRID_KEY(x,y)	(((x) * 31 + (y)) & (GRIDHASH-1))
+#define GRIDSPAN		4		/* clients over more cells per axis go on gridwide */
+
 enum {Background, Default, Target, Hidden, Normal, Sticky, Urgent, Title, TagList, LASTColor };
 enum {MOff, MWMove, MWResize, MDMove, MDResize };
+enum {WMProtocols, WMDelete, NetSyncRequest, NetSyncCounter, LASTAtom };
+enum {ListTag, ListVisible, LASTList };
+enum {BarTags, BarOverview, BarTarget, BarTitle, BarStatus,
+	LASTBar = BarStatus + STATUS_SOURCES };
 
 typedef struct {
 	unsigned int mod;
@@ -44,22 +85,137 @@ typedef struct {
 	const char *arg;
 } Button;
 
+/* what the server was last told about a client window */
+typedef struct {
+	int x, y, w, h;
+	int border;
+	Window parent;
+	Bool mapped;		/* only a mapped window is unmapped by a reparent */
+	int unmaps;		/* UnmapNotify events our own reparenting will cause */
+	XSyncCounter counter;	/* _NET_WM_SYNC_REQUEST_COUNTER or None */
+	XSyncAlarm alarm;
+	unsigned int serial;
+	double syncdue;		/* resizes held until the alarm or this time */
+} Shadow;
+
 typedef struct Client Client;
+typedef struct GridNode GridNode;
 struct Client {
 	char *title;
-//	int tlen;
-	int x, y;
-	float w, h;
-	int tags, flags;
-	Client *next;
+	int tlen;
+	int tchars, twidth;		/* cached length and pixel width of title */
+	int tgen;			/* stamped from titlegen when the title changes */
+	int id;
+	int seq, gx, gy;		/* gx,gy: the cell holding the centre */
+	int x0, y0, x1, y1;		/* the cells the rectangle covers */
+	Shadow drawn;
+	Client *next, *prev;
+	Client *lnext[LASTList], *lprev[LASTList];	/* within each target list */
+	Client *hnext;
+	GridNode *cells;
 	Window win;
 	Window parent;
+	Picture pict;		/* overview source, made on first use */
+	int ax, ay, agen;	/* position when animation agen started */
+};
+
+/* one cell a client's rectangle covers, in that cell's bucket */
+struct GridNode {
+	Client *c;
+	int x, y;
+	GridNode *next, **prev;
+	GridNode *cnext;		/* the client's next cell */
+};
+
+/* client geometry lives in parallel arrays indexed by the dense Client id */
+typedef struct Geometry Geometry;
+struct Geometry {
+	int *x, *y;
+	float *w, *h;
+	int *tags, *flags;
+	Client **client;
+	int n, size;
+};
+
+/* fixed-size records are carved from slabs and recycled through a free list */
+typedef struct Pool Pool;
+struct Pool {
+	size_t size;
+	void *free;
+	int live, peak;
 };
 
+/* an in-flight pan of (x,y) followed by a zoom about the origin */
+typedef struct {
+	Bool active, hold;
+	int x, y, gen;
+	float zoom, progress;
+	double start, next;
+	void (*done)();
+} Animation;
+
+/* a status line compiled to drawing ops; text runs index into text[] */
+typedef struct {
+	char type;		/* 't'ext or 'i'con */
+	unsigned long pixel;
+	int arg, len;	/* text offset and length, or icon number */
+	unsigned int hash;
+	int x, w;
+} StatusOp;
+
+typedef struct {
+	unsigned int hash;
+	int len, n, width;
+	char text[STATUS_TEXT+1];
+	StatusOp op[STATUS_OPS];
+} StatusList;
+
+/* a bar region's painted extent and the state it was painted from */
+typedef struct {
+	int x, w;
+	int key[5];
+} BarRegion;
+
+/* scaled previews over the desktop: screen = zoom * real + (x,y) */
+typedef struct {
+	Bool active;
+	float zoom, x, y;
+	Window win;
+	Pixmap back;
+	Picture dst;
+} Overview;
+
+/* wheel zoom ticks folded into one commit: real = factor * real + (x,y) */
+typedef struct {
+	Bool active;
+	Client *c;		/* NULL zooms the desktop */
+	float factor, x, y;
+	double first, due;
+} Gesture;
+
+/* a non-blocking status input: bytes land in the ring, and only the
+ * newest complete line is kept for the next repaint into its own segment */
+typedef struct {
+	int fd, efd;		/* text pipe and shared memory doorbell */
+	FILE *pipe;
+	ShmStatus *shm;
+	Bool fromshm, rung;
+	char ring[STATUS_RING];
+	unsigned int head, tail;	/* consumed up to head, filled up to tail */
+	Bool skip;		/* the ring overflowed inside the current line */
+	Bool pending, ready;
+	char line[STATUS_TEXT+1];
+	double last, rate;
+	StatusList list[2];
+	int cur, width, gen;
+	Pixmap pix;
+} StatusSource;
+
 typedef struct Checkpoint Checkpoint;
 struct Checkpoint {
 	int x,y;
 	float zoom;
+	int ax, ay;		/* position when the current animation started */
 	char key;
 	Checkpoint *next;
 };
@@ -76,72 +232,143 @@ static void motionnotify(XEvent *);
 static void propertynotify(XEvent *);
 static void unmapnotify(XEvent *);
 
-static void animate(int,int);
+static void animate(int,int,float,void (*)());
+static void animate_frame();
+static void animate_stop(Bool);
 static void animatefocus();
+static void canvas_pan(int,int);
 static void checkpoint(const char *);
+static void checkpoint_focus();
 static void checkpoint_set(const char *);
 static void checkpoint_update(int,int,float);
 static void cycle(const char *);
 static void cycle_tile(const char *);
 static void desktop(const char *);
+static int  dispatch();
 static void draw(Client *);
+static void drawbar();
 static void focusclient(Client *);
+static void focusdir(const char *);
 static void fullscreen(const char *);
+static void gesture_add(Client *,float,int,int);
+static void gesture_commit();
+static void geom_add(Client *);
+static void geom_del(Client *);
+static void grid_add(Client *);
+static void grid_del(Client *);
+static Client *grid_step(Client *,int,int);
+static void grid_update(Client *);
+static void handle(XEvent *);
+static unsigned long hexpixel(const char *);
+static unsigned long rgbpixel(unsigned int);
 static Bool intarget(Client *,int);
 static void killclient(const char *);
+static void list_build(int);
+static Bool list_has(Client *,int);
+static void list_unlink(Client *,int);
+static void list_update(Client *);
 static void move(const char *);
 static Bool neighbors(Client *);
 static Bool onscreen(Client *);
+static void outline(Bool);
+static void overview_draw();
+static void overview_enter();
+static void overview_leave();
+static Bool overview_paint(Client *);
+static Bool overview_rect(Client *,int *,int *,int *,int *);
+static void overview_zoom(float,int,int);
+static void *pool_get(Pool *);
+static void pool_put(Pool *, void *);
 static void quit(const char *);
-static void scrollwindows(Client *,int,int);
+static void scrollwindows(int,int);
 static GC   setcolor(int);
 static void shift(const char *);
 static Bool swap(Client *, Client *);
 static void switcher(const char *);
+static void sync_alarm(XEvent *);
+static void sync_expire();
+static void sync_request(Client *);
+static void sync_setup(Client *);
 static void spawn(const char *);
+static unsigned int strhash(const char *,int);
+static void status_paint(StatusSource *);
+static Bool status_read(StatusSource *);
+static void status_shm(StatusSource *);
+static void status_shm_open(StatusSource *);
 static void tag(const char *);
 static void tagconfig(const char *);
 static void target(const char *);
 static void tile_one(Client *);
 static void tile(const char *);
+static void title_fetch(Client *);
+static void title_free(Client *);
+static void title_set(Client *, const char *);
 static void toggletag(const char *);
 static void unmanage(Client *);
 static void window(const char *);
 static Client *wintoclient(Window);
+static void winhash_add(Client *);
+static void winhash_del(Client *);
 static void zoomwindow(Client *,float,int,int);
-static void zoom(Client *,float,int,int);
+static void zoom(float,int,int);
 
-static const int max_status_line = 512;
 #include "config.h"
 
 static Display * dpy;
-static Window root, bar;
-static Pixmap buf, sbar;
+static Window root, bar, canvas = None;
+static int canvasx = 0, canvasy = 0;
+static Shadow canvasdrawn;
+static Overview ov;
+static Gesture gesture;
+static int syncevent = -1, syncwaiting = 0;
+static double syncdue = 0;
+static Pixmap buf;
 static int scr, sw, sh;
-static GC gc;
+static GC gc, xorgc;
+static struct { Bool shown; int x, y, w, h; double last; Client *c; } drag;
 #ifdef __SCWM_ICONS_H__
-static Pixmap iconbuf;
+static Pixmap iconmask[sizeof(icons)/sizeof(icons[0])];
 static GC bgc;
 #endif
 static Colormap cmap;
 static XFontStruct *fontstruct;
 static int fontheight, barheight;
-static XWindowAttributes attr;
+static Atom atoms[LASTAtom];
 static XButtonEvent start;
 static int mousemode;
-static XColor color;
+static unsigned long pixels[LASTColor];
+static struct { unsigned int rgb; unsigned long pixel; } hexcache[HEXCACHE];
+static int nhexcache = 0;
 static Client *clients=NULL;
+static Client *winhash[WINHASH];
+static GridNode *grid[GRIDHASH], *gridwide = NULL;
+static int colcount[GRIDHASH], rowcount[GRIDHASH];
+static int gridn = 0, gridx0, gridx1, gridy0, gridy1;	/* bounds of the cells in grid */
+static Geometry geom;
+static int clientseq = 0;
+static Client *lhead[LASTList];
+static Bool lvalid[LASTList];
 static Client *focused=NULL,*slave=NULL;
 static Client *nextintarg=NULL,*previntarg=NULL;
 static Bool holdfocused=False;
+static Animation anim;
+static Checkpoint *cpjump=NULL;
 static Checkpoint *checks=NULL;
+static Pool client_pool = { sizeof(Client) };
+static Pool checkpoint_pool = { sizeof(Checkpoint) };
+static Pool gridnode_pool = { sizeof(GridNode) };
+static Pool title_pool[] = { {32}, {64}, {128}, {256}, {TITLE_MAX} };
 static Bool running = True;
 static int tags_stik = 0, tags_hide = 0, tags_urg = 0;
 static int curtag = 0;
 static int ntilemode = 0;
 static char curtile[2] = "0";
-static int statuswidth = 0;
-static FILE *inpipe;
+static int titlegen = 0;
+static BarRegion region[LASTBar];
+static int bardirty = ~0;
+static int tagwidth[32], openwidth, commawidth, closewidth, targetwidth, targetstep;
+static StatusSource sources[STATUS_SOURCES];
+static int nsources = 0;
 static char targetmode = 's';
 static const char *noname_window = "(UNNAMED)";
 //static Bool fullscreenstate = False;
@@ -159,37 +386,159 @@ static void (*handler[LASTEvent]) (XEvent *) = {
 	[UnmapNotify]		= unmapnotify,
 };
 
-void animate(int tx,int ty) {
+static double monotonic() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC,&ts);
+	return ts.tv_sec + ts.tv_nsec/1e9;
+}
+
+/* an animation that is folded or stopped short never lands, so its done
+ * is dropped along with any checkpoint jump waiting on it */
+static void animate_drop() {
+	if (anim.done == checkpoint_focus) cpjump = NULL;
+	anim.done = NULL;
+}
+
+/* frames are stepped from the main loop; a call while one is in flight
+ * folds whatever is left of it into the new target */
+void animate(int tx, int ty, float factor, void (*done)()) {
+	Checkpoint *cp;
+	int i;
 	if (!animations) {
-		scrollwindows(clients,tx,ty);
+		scrollwindows(tx,ty);
+		if (factor != 1) zoom(factor,0,0);
+		if (done) done();
 		return;
 	}
-	int dx = (tx == 0 ? 0 : (tx > 0 ? animatespeed+1 : -(animatespeed+1)));
-	int dy = (ty == 0 ? 0 : (ty > 0 ? animatespeed+1 : -(animatespeed+1)));
-	while (abs(tx) > animatespeed || abs(ty) > animatespeed) {
-		scrollwindows(clients,dx,dy);
-		tx -= dx; ty -= dy;
-		if (abs(tx) < animatespeed+1) dx = 0;
-		if (abs(ty) < animatespeed+1) dy = 0;
+	if (anim.active) {
+		float c = 1 + (anim.zoom - 1) * anim.progress;
+		tx = c * anim.x * (1 - anim.progress) + tx * c / anim.zoom;
+		ty = c * anim.y * (1 - anim.progress) + ty * c / anim.zoom;
+		factor *= anim.zoom / c;
+		anim.hold |= holdfocused;
+		animate_drop();
+	}
+	else anim.hold = holdfocused;
+	anim.x = tx; anim.y = ty;
+	anim.zoom = factor;
+	anim.progress = 0;
+	anim.start = anim.next = monotonic();
+	anim.done = done;
+	anim.active = True;
+	/* frames are computed from here, not from the previous frame */
+	anim.gen++;
+	for (i = 0; i < geom.n; i++) {
+		geom.client[i]->ax = geom.x[i];
+		geom.client[i]->ay = geom.y[i];
+		geom.client[i]->agen = anim.gen;
+	}
+	for (cp = checks; cp; cp = cp->next) {
+		cp->ax = cp->x;
+		cp->ay = cp->y;
+	}
+	animate_frame();
+}
+
+/* progress comes from the clock, so a slow commit skips frames; at progress
+ * p a start position v is at c*(v + p*(x,y)), and each frame moves things by
+ * the rounded difference from the last so nothing drifts off the target */
+void animate_frame() {
+	double now = monotonic();
+	float t = (now - anim.start) * 1000 / animatetime, p, q, c, cq, r, w, h;
+	int i, dx, dy, hold = (anim.hold && focused ? focused->id : -1);
+	Client *cl;
+	Checkpoint *cp;
+	if (t > 1) t = 1;
+	p = 1 - (1-t)*(1-t)*(1-t);		/* ease out */
+	q = anim.progress;
+	c = 1 + (anim.zoom - 1) * p;
+	cq = 1 + (anim.zoom - 1) * q;
+	r = c / cq;
+	anim.progress = p;
+	for (i = 0; i < geom.n; i++) {
+		/* sticky clients stay, ones mapped since the start are left alone */
+		cl = geom.client[i];
+		if (cl->agen != anim.gen || (geom.tags[i] & tags_stik)) continue;
+		if (i == hold) {
+			dx = ROUND(c*cl->ax) - ROUND(cq*cl->ax);
+			dy = ROUND(c*cl->ay) - ROUND(cq*cl->ay);
+		}
+		else {
+			dx = ROUND(c*(cl->ax + p*anim.x)) - ROUND(cq*(cl->ax + q*anim.x));
+			dy = ROUND(c*(cl->ay + p*anim.y)) - ROUND(cq*(cl->ay + q*anim.y));
+		}
+		geom.x[i] += dx; geom.y[i] += dy;
+		if (r != 1) {
+			w = geom.w[i] * r; h = geom.h[i] * r;
+			geom.w[i] = (w < zoom_min ? zoom_min : w);
+			geom.h[i] = (h < zoom_min ? zoom_min : h);
+		}
+		grid_update(cl);
+	}
+	for (cp = checks; cp; cp = cp->next) {
+		cp->x += ROUND(c*(cp->ax + p*anim.x)) - ROUND(cq*(cp->ax + q*anim.x));
+		cp->y += ROUND(c*(cp->ay + p*anim.y)) - ROUND(cq*(cp->ay + q*anim.y));
+		cp->zoom *= r;
+	}
+	if (canvasmode)
+		canvas_pan(ROUND(c*p*anim.x) - ROUND(cq*q*anim.x),ROUND(c*p*anim.y) - ROUND(cq*q*anim.y));
+	draw(clients);
+	anim.next = now + 1.0/animaterate;
+	if (t < 1) return;
+	anim.active = False;
+	if (anim.done) anim.done();
+}
+
+/* jump to the end when a zoom is pending or finish is set, else stay put */
+void animate_stop(Bool finish) {
+	if (!anim.active) return;
+	if (!finish && anim.zoom == 1) {
+		anim.active = False;
+		animate_drop();
+		return;
 	}
-	scrollwindows(clients,tx,ty);
+	anim.start = 0;
+	animate_frame();
 }
 
 void animatefocus() {
 	if ( !animations || !focused || !scrolltofocused || onscreen(focused)) return;
-	int tx=-focused->x+tilegap, ty=-focused->y+(showbar?barheight:0)+tilegap;
-	animate(tx,ty);
+	animate_stop(False);
+	int tx=-CX(focused)+tilegap, ty=-CY(focused)+(showbar?barheight:0)+tilegap;
+	animate(tx,ty,1,NULL);
 }
 
 void buttonpress(XEvent *e) {
 	XButtonEvent *ev = &e->xbutton;
 	Client *c;
-	if ((c=wintoclient(ev->subwindow))) focused = c;
+	Window w = ev->subwindow;
+	int x, y, cw, ch;
+	/* wheel ticks may add to a pending zoom, anything else lands it first */
+	if (ev->button != Button4 && ev->button != Button5) gesture_commit();
+	if (canvasmode && (w == canvas || ev->window == canvas))
+		XTranslateCoordinates(dpy,root,canvas,ev->x_root,ev->y_root,&x,&y,&w);
+	if (ov.active && ev->window == ov.win) {
+		for (c = clients, w = None; c; c = c->next)
+			if (overview_rect(c,&x,&y,&cw,&ch) && ev->x >= x && ev->x < x + cw &&
+					ev->y >= y && ev->y < y + ch) {
+				w = c->win;
+				if (c == focused) break;
+			}
+		/* a click on the overview only picks a client */
+		overview_leave();
+		if ((c=wintoclient(w))) {
+			focusclient(c);
+			draw(clients);
+		}
+		return;
+	}
+	if ((c=wintoclient(w))) focused = c;
 	if (!(ev->state || focused)) return;
 	int i;
 	start = *ev;
 	for (i = 0; i < sizeof(buttons)/sizeof(buttons[0]); i++)
 		if ( (ev->button == buttons[i].button) && buttons[i].func &&
+				(!ov.active || buttons[i].func == desktop) &&
 				buttons[i].mod == ((ev->state&~Mod2Mask)&~LockMask) )
 			buttons[i].func(buttons[i].arg);
 	if (c) focusclient(c);
@@ -200,9 +549,22 @@ void buttonpress(XEvent *e) {
 
 void buttonrelease(XEvent *e) {
 	XUngrabPointer(dpy, CurrentTime);
+	/* the deferred size is committed here */
+	if (mousemode == MWResize) {
+		outline(False);
+		drag.c = NULL;
+		draw(clients);
+	}
 	mousemode = MOff;
 }
 
+/* re-base once the canvas edge would come into view */
+void canvas_pan(int x, int y) {
+	canvasx += x; canvasy += y;
+	if (canvasx > 0 || canvasx < sw - CANVAS) canvasx = (sw - CANVAS)/2;
+	if (canvasy > 0 || canvasy < sh - CANVAS) canvasy = (sh - CANVAS)/2;
+}
+
 static char checkpoint_helper(const char *arg) {
 	if (arg == NULL) {
 		XGrabKeyboard(dpy,root,True,GrabModeAsync,GrabModeAsync,CurrentTime);
@@ -223,7 +585,7 @@ void checkpoint_init() {
 	int i;
 	Checkpoint *cp;
 	for (i = 0; i < 1 || tag_name[i-1]; i++) {
-		cp = (Checkpoint *) calloc(1,sizeof(Checkpoint));
+		cp = (Checkpoint *) pool_get(&checkpoint_pool);
 		cp->zoom = 1.0;
 		cp->key =  48 + i;
 		cp->y = (i > 0 ? sh*(i-1) : 0);
@@ -235,22 +597,30 @@ void checkpoint_init() {
 void checkpoint(const char *arg) {
 	char key = checkpoint_helper(arg);
 	Checkpoint *cp;
-	Client *prev = focused;
 	for (cp = checks; cp; cp = cp->next) {
 		if (cp->key == key) {
-			animate(-cp->x,-cp->y);
-			zoom(clients,1/cp->zoom,0,0);
-			focused = clients;
-			while (focused && !(onscreen(focused) || (focused->tags & tags_hide)) )
-				focused=focused->next;
-			if (focused) focusclient(focused);
-			else focused=prev;
-			draw(clients);
+			animate_stop(False);
+			cpjump = cp;
+			animate(-cp->x,-cp->y,1/cp->zoom,checkpoint_focus);
 			return;
 		}
 	}
 }
 
+/* runs once a checkpoint jump lands */
+void checkpoint_focus() {
+	Client *prev = focused;
+	if (cpjump && (cpjump->x || cpjump->y))
+		scrollwindows(-cpjump->x,-cpjump->y);	/* absorb rounding */
+	cpjump = NULL;
+	focused = clients;
+	while (focused && !(onscreen(focused) || (CTAGS(focused) & tags_hide)) )
+		focused=focused->next;
+	if (focused) focusclient(focused);
+	else focused=prev;
+	draw(clients);
+}
+
 void checkpoint_set(const char *arg) {
 	char key = checkpoint_helper(arg);
 	if (key == '0') return; /* never reset checkpoint zero */
@@ -262,7 +632,7 @@ void checkpoint_set(const char *arg) {
 			cp->zoom = 1.0;
 			return;
 		}
-	cp = (Checkpoint *) calloc(1,sizeof(Checkpoint));
+	cp = (Checkpoint *) pool_get(&checkpoint_pool);
 	cp->next = checks;
 	cp->zoom = 1.0;
 	cp->key = key;
@@ -288,7 +658,9 @@ void configurerequest(XEvent *e) {
 	XWindowChanges wc;
 	XConfigureRequestEvent *ev = &e->xconfigurerequest;
 	Client *c;
-	if ( (c=wintoclient(ev->window)) && (ev->x==0) && (ev->y==0) &&
+	int ox = (canvasmode && ev->parent == canvas ? canvasx : 0);
+	int oy = (canvasmode && ev->parent == canvas ? canvasy : 0);
+	if ( (c=wintoclient(ev->window)) && (ev->x+ox==0) && (ev->y+oy==0) &&
 			(ev->width==sw) && (ev->height==sh) ) {
 		focusclient(c);
 		fullscreen(NULL);
@@ -300,7 +672,7 @@ void configurerequest(XEvent *e) {
 	wc.sibling = ev->above;
 	wc.stack_mode = e->xconfigurerequest.detail;
 	XConfigureWindow(dpy, ev->window, ev->value_mask, &wc);
-	XFlush(dpy);
+	if (c) c->drawn.w = 0;
 }
 
 void cycle(const char *arg) {
@@ -314,32 +686,25 @@ void cycle(const char *arg) {
 		if (!focused) focused = clients;
 	}
 	else if (tm == 'v') {
-		while ( (focused=focused->next) && (focused->tags & tags_hide) );
-		if (!focused) {
-			focused = clients;
-			if (clients && (clients->tags & tags_hide) )
-				while ((focused=focused->next)->tags & tags_hide );
-		}
+		/* around the visible list, past clients with any hidden tag */
+		list_build(ListVisible);
+		for (focused = prev->lnext[ListVisible]; focused && (CTAGS(focused) & tags_hide);
+				focused = focused->lnext[ListVisible]);
+		if (!focused) for (focused = lhead[ListVisible]; focused && (CTAGS(focused) & tags_hide);
+				focused = focused->lnext[ListVisible]);
 	}
 	else if (tm == 's') {
-		while (focused && (!onscreen(focused=focused->next) || (focused->tags & tags_hide)) );
-		if (!focused) {
-			if ( !onscreen(focused=clients) || (focused->tags & tags_hide) )
-				while (focused && (!onscreen(focused=focused->next) || (focused->tags & tags_hide)) );
-		}
+		if (!(focused=grid_step(prev,1,tags_hide)))
+			focused = grid_step(NULL,1,tags_hide);
 	}
 	else if (tm == 't') {
-		while ( (focused=focused->next) && !(focused->tags & prev->tags) );
-		if (!focused) {
-			focused = clients;
-			if ( clients && !(clients->tags & prev->tags) )
-				while ( (focused=focused->next) && !(focused->tags & prev->tags) );
-		}
+		list_build(ListTag);
+		if (!(focused=prev->lnext[ListTag])) focused = lhead[ListTag];
 	}
 	else if (tm == 'o') {
 		if (!focused || !slave) return;
 		if (focused == slave)
-			for (focused = clients; !onscreen(focused); focused = focused->next);
+			focused = grid_step(NULL,1,0);
 		else
 			focused = slave;
 	}
@@ -357,98 +722,252 @@ void cycle_tile(const char *arg) {
 void destroynotify(XEvent *e) {
 	Client *c;
 	if (!(c=wintoclient(e->xunmap.window))) return;
-	if (!e->xunmap.send_event) unmanage(c);
+	if (e->xunmap.send_event) return;
+	c->pict = None;		/* the server freed it with the window */
+	unmanage(c);
 }
 
 void desktop(const char *arg) {
+	animate_stop(False);
 	if (arg[0] == 'm') mousemode = MDMove;
 	else if (arg[0] == 'r') mousemode = MDResize;
-	else if (arg[0] == 'g') zoom(clients,1.1,start.x_root,start.y_root);
-	else if (arg[0] == 's') zoom(clients,.92,start.x_root,start.y_root);
+	else if (arg[0] == 'o' && ov.active) overview_leave();
+	else if (arg[0] == 'o') overview_enter();
+	else if (arg[0] == 'g' && ov.active) overview_zoom(1.1,start.x_root,start.y_root);
+	else if (arg[0] == 's' && ov.active) overview_zoom(.92,start.x_root,start.y_root);
+	else if (arg[0] == 'g') gesture_add(NULL,1.1,start.x_root,start.y_root);
+	else if (arg[0] == 's') gesture_add(NULL,.92,start.x_root,start.y_root);
+}
+
+/* one batch off the queue: input and structural events in arrival order,
+ * then property changes with only the last of each (window, atom) pair
+ * kept, so a key press is never stuck behind a client's property storm;
+ * a batch ends at the first key press, button press or motion, so what
+ * follows stays in Xlib's queue for checkpoint keys and motion coalescing
+ * to find, and a click sees every map and destroy before it */
+int dispatch() {
+	static XEvent batch[EVBATCH];
+	int prop[EVBATCH];
+	int i, j, type, n = 0, np = 0;
+	while (n < EVBATCH && XEventsQueued(dpy,QueuedAfterReading)) {
+		XNextEvent(dpy,&batch[n]);
+		type = batch[n++].type;
+		if (type == KeyPress || type == ButtonPress || type == MotionNotify) break;
+	}
+	for (i = 0; i < n; i++) switch (batch[i].type) {
+		case PropertyNotify:
+			for (j = 0; j < np; j++)
+				if (batch[prop[j]].xproperty.window == batch[i].xproperty.window &&
+						batch[prop[j]].xproperty.atom == batch[i].xproperty.atom) break;
+			prop[j] = i;
+			if (j == np) np++;
+			break;
+		default:
+			handle(&batch[i]);
+	}
+	for (j = 0; j < np; j++) handle(&batch[prop[j]]);
+	return n;
 }
 
 void draw(Client *stack) {
-	if (focused) tags_urg &= ~focused->tags;
-	tags_urg &= ~(1<<curtag);
 	/* WINDOWS */
-	int tags_occ = 0;
-	int loc[9] = {0,0,0,0,0,0,0,0,0}, cx,cy;
+	int x, y, w, h, col;
+	Shadow *d;
+	Window parent;
 	XSetWindowAttributes wa;
+	Bool shown = drag.shown;
+	/* the outline goes before anything moves under it */
+	if (shown) outline(False);
+	/* in canvas mode a pan is this one request */
+	if (canvasmode && (canvasx != canvasdrawn.x || canvasy != canvasdrawn.y)) {
+		XMoveWindow(dpy,canvas,canvasx,canvasy);
+		canvasdrawn.x = canvasx; canvasdrawn.y = canvasy;
+	}
 	while (stack) {
-		cx = stack->x + stack->w/2;
-		cy = stack->y + stack->h/2;
-		loc[(cx<0?0:(cx<sw?1:2))*3 + (cy<0?0:(cy<sh?1:2))]++;
-		tags_occ |= stack->tags;
-		if (stack->tags & tags_hide) {
-			XMoveWindow(dpy,stack->win,sw+2,0);
+		/* only send what differs from the last committed state */
+		d = &stack->drawn;
+		parent = (canvasmode && !(CTAGS(stack) & (tags_stik | tags_hide)) ? canvas : root);
+		if (CTAGS(stack) & tags_hide) {
+			if (parent != d->parent) {
+				if (d->mapped) d->unmaps++;
+				XReparentWindow(dpy,stack->win,parent,sw+2,0);
+				d->parent = parent;
+			}
+			else if (d->x != sw+2 || d->y != 0 || !d->w)
+				XMoveWindow(dpy,stack->win,sw+2,0);
+			d->x = sw+2; d->y = 0;
 			stack = stack->next;
 			continue;
 		}
-		XMoveResizeWindow(dpy,stack->win,stack->x,stack->y,
-			MAX(stack->w,win_min),MAX(stack->h,win_min));
-		setcolor( (highlightfocused && stack == focused ? Hidden :
-			(stack->tags & tags_stik ? Sticky : Normal)) );
-		wa.border_pixel = color.pixel;
-		XChangeWindowAttributes(dpy,stack->win,CWBorderPixel,&wa);
+		w = MAX(CW(stack),win_min); h = MAX(CH(stack),win_min);
+		x = CX(stack); y = CY(stack);
+		if (parent == canvas) {
+			/* keep far away clients off the canvas and inside 16 bits */
+			x -= canvasx; y -= canvasy;
+			if (x > CANVAS) x = CANVAS; else if (x + w < 0) x = -w;
+			if (y > CANVAS) y = CANVAS; else if (y + h < 0) y = -h;
+		}
+		if (parent != d->parent) {
+			if (d->mapped) d->unmaps++;
+			XReparentWindow(dpy,stack->win,parent,x,y);
+			d->parent = parent; d->x = x; d->y = y;
+		}
+		/* a client still repainting the last size, or being resized under
+		 * an outline, keeps it for now */
+		if ((w != d->w || h != d->h) && (d->syncdue || stack == drag.c) && d->w) {
+			w = d->w; h = d->h;
+		}
+		if (w != d->w || h != d->h) {
+			if (d->counter) sync_request(stack);
+			XMoveResizeWindow(dpy,stack->win,x,y,w,h);
+		}
+		else if (x != d->x || y != d->y)
+			XMoveWindow(dpy,stack->win,x,y);
+		col = (highlightfocused && stack == focused ? Hidden :
+			(CTAGS(stack) & tags_stik ? Sticky : Normal));
+		if (col != d->border || !d->w) {
+			wa.border_pixel = pixels[col];
+			XChangeWindowAttributes(dpy,stack->win,CWBorderPixel,&wa);
+		}
+		d->x = x; d->y = y; d->w = w; d->h = h; d->border = col;
 		stack = stack->next;
 	}
-	/* STATUS BAR */
-	XFillRectangle(dpy,buf,setcolor(Background),0,0,sw,barheight);
-	/* tags */
-	int i, x=10,w=0;
-	int col;
-	for (i = 0; tag_name[i]; i++) {
-		if (!(tags_occ & (1<<i)) && curtag != i) continue;
-		col = (tags_urg & (1<<i) ? Urgent :
-				(tags_hide & (1<<i) ? Hidden :
-				(tags_stik & (1<<i) ? Sticky : 
-				(tags_occ  & (1<<i) ? Normal : Default ))));
-		XDrawString(dpy,buf,setcolor(col),x,fontheight,tag_name[i],strlen(tag_name[i]));
-		w = XTextWidth(fontstruct,tag_name[i],strlen(tag_name[i]));
-		if (curtag == i)
-			XFillRectangle(dpy,buf,gc,x-2,fontheight+1,w+4,barheight-fontheight);
-		x+=w+10;
+	drawbar();
+	if (ov.active) overview_draw();
+	if (shown) outline(True);
+}
+
+/* repaint the bar into buf and copy it out: no client window requests */
+void drawbar() {
+	if (focused) tags_urg &= ~CTAGS(focused);
+	tags_urg &= ~(1<<curtag);
+	int tags_occ = 0, locs = 0, cx, cy;
+	int i, j, x, w, col, dirty, left;
+	StatusSource *src;
+	int lo[LASTBar], hi[LASTBar];
+	BarRegion next[LASTBar];
+	for (i = 0; i < geom.n; i++) {
+		cx = geom.x[i] + geom.w[i]/2;
+		cy = geom.y[i] + geom.h[i]/2;
+		locs |= 1 << ((cx<0?0:(cx<sw?1:2))*3 + (cy<0?0:(cy<sh?1:2)));
+		tags_occ |= geom.tags[i];
 	}
-	/* overview "icon" and target indicator*/
+	/* lay out regions from cached widths */
+	memset(next,0,sizeof(next));
+	x = 10;
+	for (i = 0; tag_name[i]; i++)
+		if ((tags_occ & (1<<i)) || curtag == i) x += tagwidth[i] + 10;
+	next[BarTags] = (BarRegion) { 8, MAX(x-16,0),
+			{ tags_occ, tags_urg, tags_hide, tags_stik, curtag } };
 	if (clients) {
 		x = MAX(x+20,sw/10);
+		next[BarOverview] = (BarRegion) { x, 10, { locs } };
+		x+=18;
+	}
+	if (targetmode != 's') {
+		next[BarTarget] = (BarRegion) { x, targetwidth, { targetmode } };
+		x += targetstep + 18;
+	}
+	left = x;
+	if (focused) {
+		w = focused->twidth + 10 + openwidth;
+		for (i = 0, j = 0; tag_name[i]; i++) if (CTAGS(focused) & (1<<i)) {
+			w += tagwidth[i] + commawidth;
+			j++;
+		}
+		if (j) w -= commawidth;
+		next[BarTitle] = (BarRegion) { x, w + MAX(closewidth,10),
+				{ focused->seq, CTAGS(focused), focused->tgen } };
+	}
+	/* status segments line up from the right edge, the first source leftmost;
+	 * those that would reach the tags, overview or target are left out */
+	for (x = sw, i = nsources - 1; i >= 0; i--) if ((src=&sources[i])->width) {
+		if (x - src->width < left) break;
+		x -= src->width;
+		next[BarStatus+i] = (BarRegion) { x, src->width, { src->gen } };
+		x -= 10;
+	}
+	/* a region is damaged when its extent or state changed */
+	dirty = bardirty;
+	for (i = 0; i < LASTBar; i++) {
+		if (memcmp(&next[i],&region[i],sizeof(BarRegion))) dirty |= 1<<i;
+		lo[i] = sw; hi[i] = 0;
+		if (region[i].w > 0) {
+			lo[i] = region[i].x; hi[i] = region[i].x + region[i].w;
+		}
+		if (next[i].w > 0) {
+			lo[i] = MIN(lo[i],next[i].x); hi[i] = MAX(hi[i],next[i].x + next[i].w);
+		}
+	}
+	/* a long title can run under the status text */
+	for (i = BarStatus; i < LASTBar; i++)
+		if ((dirty & (1<<BarTitle | 1<<i)) && hi[BarTitle] > lo[i] && hi[i] > lo[BarTitle])
+			dirty |= 1<<BarTitle | 1<<i;
+	if (!dirty) return;
+	setcolor(Background);
+	for (i = 0; i < LASTBar; i++) if ((dirty & (1<<i)) && hi[i] > lo[i])
+		XFillRectangle(dpy,buf,gc,lo[i],0,hi[i]-lo[i],barheight);
+	/* tags */
+	if (dirty & (1<<BarTags)) {
+		x = 10;
+		for (i = 0; tag_name[i]; i++) {
+			if (!(tags_occ & (1<<i)) && curtag != i) continue;
+			col = (tags_urg & (1<<i) ? Urgent :
+					(tags_hide & (1<<i) ? Hidden :
+					(tags_stik & (1<<i) ? Sticky : 
+					(tags_occ  & (1<<i) ? Normal : Default ))));
+			XDrawString(dpy,buf,setcolor(col),x,fontheight,tag_name[i],strlen(tag_name[i]));
+			if (curtag == i)
+				XFillRectangle(dpy,buf,gc,x-2,fontheight+1,tagwidth[i]+4,barheight-fontheight);
+			x+=tagwidth[i]+10;
+		}
+	}
+	/* overview "icon" and target indicator*/
+	if ((dirty & (1<<BarOverview)) && clients) {
+		x = next[BarOverview].x;
 		XDrawRectangle(dpy,buf,setcolor(Default),x,fontheight-9,6,6);
 		XDrawRectangle(dpy,buf,gc,x,fontheight-6,6,6);
 		XDrawRectangle(dpy,buf,gc,x+3,fontheight-9,6,6);
 		XDrawRectangle(dpy,buf,gc,x+3,fontheight-6,6,6);
 		setcolor(Hidden);
-		for (i = 0; i < 3; i++) for (w = 0; w < 3; w++) if (loc[i*3+w])
+		for (i = 0; i < 3; i++) for (w = 0; w < 3; w++) if (locs & (1<<(i*3+w)))
 			XFillRectangle(dpy,buf,gc,x+3*i,fontheight-9+3*w,4,4);
-		x+=18;
 	}
-	setcolor(Target);
-	if (targetmode == 't') XDrawString(dpy,buf,gc,x,fontheight,"[tag]",5);
-	else if (targetmode == 'v') XDrawString(dpy,buf,gc,x,fontheight,"[vis]",5);
-	if (targetmode != 's') x += XTextWidth(fontstruct,"[all]",4) + 18;
+	if ((dirty & (1<<BarTarget)) && targetmode != 's') {
+		x = next[BarTarget].x;
+		setcolor(Target);
+		if (targetmode == 't') XDrawString(dpy,buf,gc,x,fontheight,"[tag]",5);
+		else if (targetmode == 'v') XDrawString(dpy,buf,gc,x,fontheight,"[vis]",5);
+	}
 	/* title */
-	if (focused) {
+	if ((dirty & (1<<BarTitle)) && focused) {
+		x = next[BarTitle].x;
 		setcolor(Title);
-		XDrawString(dpy,buf,gc,x,fontheight,focused->title,strlen(focused->title));
-		x += XTextWidth(fontstruct,focused->title,strlen(focused->title)) + 10;
+		XDrawString(dpy,buf,gc,x,fontheight,focused->title,focused->tchars);
+		x += focused->twidth + 10;
 		XDrawString(dpy,buf,setcolor(TagList),x,fontheight,"[",1);
-		x += XTextWidth(fontstruct,"[",1);
+		x += openwidth;
 		/* tag list */
-		for (i = 0; tag_name[i]; i++) if (focused->tags & (1<<i)) {
+		w = 0;
+		for (i = 0; tag_name[i]; i++) if (CTAGS(focused) & (1<<i)) {
 			XDrawString(dpy,buf,gc,x,fontheight,tag_name[i],strlen(tag_name[i]));
-			x += XTextWidth(fontstruct,tag_name[i],strlen(tag_name[i]));
+			x += tagwidth[i];
 			XDrawString(dpy,buf,gc,x,fontheight,", ",2);
-			w = XTextWidth(fontstruct,", ",2);
-			x += w;
+			x += (w = commawidth);
 		}
 		x -= w;
 		XFillRectangle(dpy,buf,setcolor(Background),x,0,10,barheight);
 		XDrawString(dpy,buf,setcolor(TagList),x,fontheight,"]",1);
 	}
 	/* USER STATUS INFO */
-	if (statuswidth)
-		XCopyArea(dpy,sbar,buf,gc,0,0,statuswidth,barheight,sw-statuswidth,0);
-	XCopyArea(dpy,buf,bar,gc,0,0,sw,barheight,0,0);
-	XFlush(dpy);
+	for (i = 0; i < nsources; i++) if ((dirty & (1<<(BarStatus+i))) && next[BarStatus+i].w)
+		XCopyArea(dpy,sources[i].pix,buf,gc,0,0,sources[i].width,barheight,
+				next[BarStatus+i].x,0);
+	/* copy out only what was repainted */
+	for (i = 0; i < LASTBar; i++) if ((dirty & (1<<i)) && hi[i] > lo[i])
+		XCopyArea(dpy,buf,bar,gc,lo[i],0,hi[i]-lo[i],barheight,lo[i],0);
+	memcpy(region,next,sizeof(region));
+	bardirty = 0;
 }
 
 void enternotify(XEvent *e) {
@@ -461,7 +980,10 @@ void enternotify(XEvent *e) {
 }
 
 void expose(XEvent *e) {
-	draw(clients);
+	if (ov.active && e->xexpose.window == ov.win)
+		XCopyArea(dpy,ov.back,ov.win,gc,0,0,sw,sh,0,0);
+	else
+		XCopyArea(dpy,buf,bar,gc,0,0,sw,barheight,0,0);
 }
 
 void focusclient(Client *c) {
@@ -471,43 +993,293 @@ void focusclient(Client *c) {
 	XRaiseWindow(dpy,c->win);
 neighbors(c);
 if (previntarg) slave = c;
-	if (!(c->flags & SCWM_FULLSCREEN)) XRaiseWindow(dpy,bar);
+	if (!(CFLAGS(c) & SCWM_FULLSCREEN)) XRaiseWindow(dpy,bar);
+}
+
+/* score one client against the best so far */
+static void focusdir_score(const char *arg, Client *c, Client **best, int *bestd) {
+	int d, dx, dy;
+	if (c == focused || (CTAGS(c) & tags_hide)) return;
+	dx = CX(c) + CW(c)/2 - CX(focused) - CW(focused)/2;
+	dy = CY(c) + CH(c)/2 - CY(focused) - CH(focused)/2;
+	if (arg[0] == 'l' && dx < 0) d = -dx + 2*abs(dy);
+	else if (arg[0] == 'r' && dx > 0) d = dx + 2*abs(dy);
+	else if (arg[0] == 'u' && dy < 0) d = -dy + 2*abs(dx);
+	else if (arg[0] == 'd' && dy > 0) d = dy + 2*abs(dx);
+	else return;
+	if (!*best || d < *bestd) { *best = c; *bestd = d; }
+}
+
+/* score the clients of one grid cell, (i,j) cells away from the focused
+ * one's centre; every client is met at the latest in its centre's cell */
+static void focusdir_cell(const char *arg, int i, int j, Client **best, int *bestd) {
+	GridNode *n;
+	int x = focused->gx + i, y = focused->gy + j;
+	/* a cell entirely behind the focused centre cannot hold a candidate's */
+	if ((arg[0] == 'l' && i > 0) || (arg[0] == 'r' && i < 0) ||
+			(arg[0] == 'u' && j > 0) || (arg[0] == 'd' && j < 0))
+		return;
+	for (n = grid[GRID_KEY(x,y)]; n; n = n->next)
+		if (n->x == x && n->y == y) focusdir_score(arg,n->c,best,bestd);
+}
+
+void focusdir(const char *arg) {
+	if (!focused) return;
+	GridNode *n;
+	Client *best = NULL;
+	int k, r, rmax, bestd = 0;
+	int cell = (sw < sh ? sw : sh);
+	for (n = gridwide; n; n = n->next) focusdir_score(arg,n->c,&best,&bestd);
+	/* no ring past the bounds of the occupied cells can hold anything */
+	rmax = (gridn ? MAX(MAX(focused->gx - gridx0,gridx1 - focused->gx),
+			MAX(focused->gy - gridy0,gridy1 - focused->gy)) : 0);
+	/* walk only the border of each ring outward until nothing closer can remain */
+	for (r = 0; r <= rmax && !(best && bestd <= (r-1)*cell); r++) {
+		if (r == 0) focusdir_cell(arg,0,0,&best,&bestd);
+		else for (k = -r; k <= r; k++) {
+			focusdir_cell(arg,k,-r,&best,&bestd);
+			focusdir_cell(arg,k,r,&best,&bestd);
+			if (k == -r || k == r) continue;
+			focusdir_cell(arg,-r,k,&best,&bestd);
+			focusdir_cell(arg,r,k,&best,&bestd);
+		}
+	}
+	if (!best) return;
+	focusclient(best);
+	animatefocus();
+	draw(clients);
 }
 
 static void fullscreen(const char *arg) {
 	if (!focused) return;
 	static int wx,wy,ww,wh;
-	if ( !(focused->flags & SCWM_FULLSCREEN) ) {
-		focused->flags |= SCWM_FULLSCREEN;
-		wx=focused->x; wy=focused->y;
-		ww=focused->w; wh=focused->h;
-		focused->x = -borderwidth; focused->y = -borderwidth;
-		focused->w = sw; focused->h = sh;
+	if ( !(CFLAGS(focused) & SCWM_FULLSCREEN) ) {
+		CFLAGS(focused) |= SCWM_FULLSCREEN;
+		wx=CX(focused); wy=CY(focused);
+		ww=CW(focused); wh=CH(focused);
+		CX(focused) = -borderwidth; CY(focused) = -borderwidth;
+		CW(focused) = sw; CH(focused) = sh;
 		XRaiseWindow(dpy,focused->win);
 	}
 	else {
-		focused->flags &= ~SCWM_FULLSCREEN;
+		CFLAGS(focused) &= ~SCWM_FULLSCREEN;
 		XRaiseWindow(dpy,bar);
-		focused->x = wx; focused->y = wy;
-		focused->w = ww; focused->h = wh;
+		CX(focused) = wx; CY(focused) = wy;
+		CW(focused) = ww; CH(focused) = wh;
 	}
+	grid_update(focused);
 	draw(clients);
 }
 
+/* each tick only composes into the pending transform and pushes the
+ * commit back, up to a few delays after the first tick */
+void gesture_add(Client *c, float factor, int x, int y) {
+	double now = monotonic();
+	if (gesture.active && gesture.c != c) gesture_commit();
+	if (!gesture.active) gesture = (Gesture) { True, c, 1, 0, 0, now, 0 };
+	gesture.factor *= factor;
+	gesture.x = (gesture.x - x) * factor + x;
+	gesture.y = (gesture.y - y) * factor + y;
+	gesture.due = MIN(now + zoomdelay/1000.0, gesture.first + 4*zoomdelay/1000.0);
+}
+
+/* apply the product as a single zoom about its fixed point */
+void gesture_commit() {
+	float f = gesture.factor;
+	int x, y;
+	if (!gesture.active) return;
+	gesture.active = False;
+	/* no zoom to speak of: keep the translation alone */
+	if (f > 0.999 && f < 1.001) {
+		if (!((int) gesture.x || (int) gesture.y)) return;
+		if (gesture.c) {
+			CX(gesture.c) += gesture.x; CY(gesture.c) += gesture.y;
+			grid_update(gesture.c);
+			draw(clients);
+		}
+		else scrollwindows(gesture.x,gesture.y);
+		return;
+	}
+	x = gesture.x / (1 - f); y = gesture.y / (1 - f);
+	if (gesture.c) {
+		zoomwindow(gesture.c,f,x,y);
+		draw(clients);
+	}
+	else zoom(f,x,y);
+}
+
+void geom_add(Client *c) {
+	if (geom.n == geom.size) {
+		geom.size = (geom.size ? geom.size*2 : 32);
+		geom.x = realloc(geom.x,geom.size*sizeof(int));
+		geom.y = realloc(geom.y,geom.size*sizeof(int));
+		geom.w = realloc(geom.w,geom.size*sizeof(float));
+		geom.h = realloc(geom.h,geom.size*sizeof(float));
+		geom.tags = realloc(geom.tags,geom.size*sizeof(int));
+		geom.flags = realloc(geom.flags,geom.size*sizeof(int));
+		geom.client = realloc(geom.client,geom.size*sizeof(Client *));
+		if (!(geom.x && geom.y && geom.w && geom.h && geom.tags && geom.flags && geom.client))
+			exit(1);
+	}
+	c->id = geom.n++;
+	geom.client[c->id] = c;
+	CX(c) = CY(c) = CTAGS(c) = CFLAGS(c) = 0;
+	CW(c) = CH(c) = 0;
+}
+
+/* keep the arrays dense by moving the last entry into the hole */
+void geom_del(Client *c) {
+	int i = c->id, l = --geom.n;
+	if (i == l) return;
+	geom.x[i] = geom.x[l]; geom.y[i] = geom.y[l];
+	geom.w[i] = geom.w[l]; geom.h[i] = geom.h[l];
+	geom.tags[i] = geom.tags[l]; geom.flags[i] = geom.flags[l];
+	geom.client[i] = geom.client[l];
+	geom.client[i]->id = i;
+}
+
+/* clients are bucketed in every screen-sized cell their rectangle covers;
+ * the rare client spanning more than GRIDSPAN cells goes on gridwide */
+static int grid_cell(int v, int size) {
+	return (v < 0 ? (v+1)/size - 1 : v/size);
+}
+
+static void grid_link(GridNode **b, Client *c, int x, int y) {
+	GridNode *n = (GridNode *) pool_get(&gridnode_pool);
+	n->c = c; n->x = x; n->y = y;
+	if ((n->next=*b)) n->next->prev = &n->next;
+	n->prev = b;
+	*b = n;
+	n->cnext = c->cells;
+	c->cells = n;
+}
+
+static Bool grid_wide(Client *c) {
+	return (c->x1 - c->x0 >= GRIDSPAN || c->y1 - c->y0 >= GRIDSPAN);
+}
+
+void grid_add(Client *c) {
+	int x, y;
+	c->gx = grid_cell(CX(c) + CW(c)/2,sw);
+	c->gy = grid_cell(CY(c) + CH(c)/2,sh);
+	c->x0 = grid_cell(CX(c),sw); c->x1 = MAX(grid_cell(CX(c) + (int) CW(c) - 1,sw),c->x0);
+	c->y0 = grid_cell(CY(c),sh); c->y1 = MAX(grid_cell(CY(c) + (int) CH(c) - 1,sh),c->y0);
+	if (grid_wide(c)) {
+		grid_link(&gridwide,c,0,0);
+		return;
+	}
+	for (x = c->x0; x <= c->x1; x++) for (y = c->y0; y <= c->y1; y++)
+		grid_link(&grid[GRID_KEY(x,y)],c,x,y);
+	for (x = c->x0; x <= c->x1; x++) colcount[x & (GRIDHASH-1)]++;
+	for (y = c->y0; y <= c->y1; y++) rowcount[y & (GRIDHASH-1)]++;
+	if (!gridn++) {
+		gridx0 = c->x0; gridx1 = c->x1; gridy0 = c->y0; gridy1 = c->y1;
+		return;
+	}
+	gridx0 = MIN(gridx0,c->x0); gridx1 = MAX(gridx1,c->x1);
+	gridy0 = MIN(gridy0,c->y0); gridy1 = MAX(gridy1,c->y1);
+}
+
+/* the bounds shrink past rows and columns that emptied; a bucket shared
+ * with another occupied row or column only leaves them a little wide */
+void grid_del(Client *c) {
+	GridNode *n;
+	int x, y;
+	while ((n=c->cells)) {
+		c->cells = n->cnext;
+		if ((*n->prev=n->next)) n->next->prev = n->prev;
+		pool_put(&gridnode_pool,n);
+	}
+	if (grid_wide(c)) return;
+	for (x = c->x0; x <= c->x1; x++) colcount[x & (GRIDHASH-1)]--;
+	for (y = c->y0; y <= c->y1; y++) rowcount[y & (GRIDHASH-1)]--;
+	if (!--gridn) return;
+	while (gridx0 < gridx1 && !colcount[gridx0 & (GRIDHASH-1)]) gridx0++;
+	while (gridx1 > gridx0 && !colcount[gridx1 & (GRIDHASH-1)]) gridx1--;
+	while (gridy0 < gridy1 && !rowcount[gridy0 & (GRIDHASH-1)]) gridy0++;
+	while (gridy1 > gridy0 && !rowcount[gridy1 & (GRIDHASH-1)]) gridy1--;
+}
+
+/* nearest onscreen client before (dir<0) or after (dir>0) c in list order:
+ * every client intersecting the viewport is in cell (0,0) or on gridwide */
+Client *grid_step(Client *c, int dir, int mask) {
+	GridNode *n;
+	Client *t, *best = NULL;
+	int i, seq = (c ? c->seq : (dir > 0 ? clientseq - 1 : 0));
+	for (i = 0; i < 2; i++) for (n = (i ? gridwide : grid[GRID_KEY(0,0)]); n; n = n->next) {
+		t = n->c;
+		if (n->x || n->y || (CTAGS(t) & mask) || !onscreen(t)) continue;
+		if (dir > 0 && t->seq > seq && (!best || t->seq < best->seq)) best = t;
+		else if (dir < 0 && t->seq < seq && (!best || t->seq > best->seq)) best = t;
+	}
+	return best;
+}
+
+void grid_update(Client *c) {
+	if (grid_cell(CX(c) + CW(c)/2,sw) == c->gx && grid_cell(CY(c) + CH(c)/2,sh) == c->gy &&
+			grid_cell(CX(c),sw) == c->x0 && grid_cell(CY(c),sh) == c->y0 &&
+			MAX(grid_cell(CX(c) + (int) CW(c) - 1,sw),c->x0) == c->x1 &&
+			MAX(grid_cell(CY(c) + (int) CH(c) - 1,sh),c->y0) == c->y1)
+		return;
+	grid_del(c);
+	grid_add(c);
+}
+
+static unsigned long maskpixel(unsigned long mask, unsigned int v) {
+	int shift = 0, bits = 0;
+	for (; mask && !(mask & 1); mask >>= 1) shift++;
+	for (; mask & 1; mask >>= 1) bits++;
+	return (unsigned long) (bits >= 8 ? v << (bits-8) : v >> (8-bits)) << shift;
+}
+
+/* "#RRGGBB" to a pixel, computed locally on TrueColor visuals */
+unsigned long hexpixel(const char *hex) {
+	return rgbpixel(strtoul(hex+1,NULL,16) & 0xFFFFFF);
+}
+
+unsigned long rgbpixel(unsigned int rgb) {
+	int i;
+	for (i = 0; i < nhexcache && i < HEXCACHE; i++)
+		if (hexcache[i].rgb == rgb) return hexcache[i].pixel;
+	Visual *vis = DefaultVisual(dpy,scr);
+	XColor color;
+	if (vis->class == TrueColor) {
+		color.pixel = maskpixel(vis->red_mask,rgb>>16) |
+			maskpixel(vis->green_mask,(rgb>>8)&0xFF) | maskpixel(vis->blue_mask,rgb&0xFF);
+	}
+	else {
+		color.red = (rgb>>16) * 0x101;
+		color.green = ((rgb>>8)&0xFF) * 0x101;
+		color.blue = (rgb&0xFF) * 0x101;
+		color.flags = DoRed | DoGreen | DoBlue;
+		XAllocColor(dpy,cmap,&color);
+	}
+	i = nhexcache++ % HEXCACHE;
+	hexcache[i].rgb = rgb;
+	hexcache[i].pixel = color.pixel;
+	return color.pixel;
+}
+
 Bool intarget(Client *c,int flags) {
 	char tm = targetmode;
-	if (c->flags & ~flags) return False;
+	if (CFLAGS(c) & ~flags) return False;
 	else if (tm == 'a') return True;
 	else if (tm == 's') return onscreen(c);
-	else if (tm == 't') return (c->tags & (1<<curtag));
-	else if (tm == 'v') return (c->tags & ~tags_hide);
+	else if (tm == 't') return (CTAGS(c) & (1<<curtag));
+	else if (tm == 'v') return (CTAGS(c) & ~tags_hide);
 	else return False;
 }
 
+void handle(XEvent *ev) {
+	if (ev->type == syncevent + XSyncAlarmNotify) sync_alarm(ev);
+	else if (ev->type < LASTEvent && handler[ev->type]) handler[ev->type](ev);
+}
+
 void keypress(XEvent *e) {
 	unsigned int i;
 	XKeyEvent *ev = &e->xkey;
 	KeySym keysym = XkbKeycodeToKeysym(dpy,(KeyCode)ev->keycode,0,0);
+	gesture_commit();
 	for (i = 0; i < sizeof(keys)/sizeof(keys[0]); i++)
 		if ( (keysym==keys[i].keysym) && keys[i].func &&
 				keys[i].mod == ((ev->state&~Mod2Mask)&~LockMask) )
@@ -519,48 +1291,99 @@ void killclient(const char *arg) {
         XEvent ev;
         ev.type = ClientMessage;
         ev.xclient.window = focused->win;
-        ev.xclient.message_type = XInternAtom(dpy, "WM_PROTOCOLS", True);
+        ev.xclient.message_type = atoms[WMProtocols];
         ev.xclient.format = 32;
-        ev.xclient.data.l[0] = XInternAtom(dpy, "WM_DELETE_WINDOW", True);
+        ev.xclient.data.l[0] = atoms[WMDelete];
         ev.xclient.data.l[1] = CurrentTime;
         XSendEvent(dpy,focused->win,False,NoEventMask,&ev);
 }
 
+/* the target lists hold clients on the current tag and clients with a tag
+ * that is not hidden, each in client list order; switching tags or hiding
+ * drops a list to be rebuilt on next use, all else keeps them current */
+Bool list_has(Client *c, int l) {
+	return ((l == ListTag ? CTAGS(c) & (1<<curtag) : CTAGS(c) & ~tags_hide) != 0);
+}
+
+void list_build(int l) {
+	Client *c, *last = NULL;
+	if (lvalid[l]) return;
+	lhead[l] = NULL;
+	for (c = clients; c; c = c->next) {
+		c->lnext[l] = c->lprev[l] = NULL;
+		if (!list_has(c,l)) continue;
+		if ((c->lprev[l]=last)) last->lnext[l] = c;
+		else lhead[l] = c;
+		last = c;
+	}
+	lvalid[l] = True;
+}
+
+void list_unlink(Client *c, int l) {
+	if (c->lprev[l]) c->lprev[l]->lnext[l] = c->lnext[l];
+	else if (lhead[l] == c) lhead[l] = c->lnext[l];
+	if (c->lnext[l]) c->lnext[l]->lprev[l] = c->lprev[l];
+	c->lnext[l] = c->lprev[l] = NULL;
+}
+
+/* bring c's links in line with its tags: one newly in a list goes after
+ * the nearest linked client before it, which for a new client is none */
+void list_update(Client *c) {
+	Client *p;
+	int l;
+	Bool linked;
+	for (l = 0; l < LASTList; l++) if (lvalid[l]) {
+		linked = (c->lprev[l] || lhead[l] == c);
+		if (linked && !list_has(c,l)) list_unlink(c,l);
+		else if (!linked && list_has(c,l)) {
+			for (p = c->prev; p && !(p->lprev[l] || lhead[l] == p); p = p->prev);
+			c->lprev[l] = p;
+			c->lnext[l] = (p ? p->lnext[l] : lhead[l]);
+			if (p) p->lnext[l] = c;
+			else lhead[l] = c;
+			if (c->lnext[l]) c->lnext[l]->lprev[l] = c;
+		}
+	}
+}
+
 void maprequest(XEvent *e) {
-	Client *c,*parent;
+	Client *c;
 	static XWindowAttributes wa;
 	Bool fsme = False;
 	XMapRequestEvent *ev = &e->xmaprequest;
 	if (!XGetWindowAttributes(dpy, ev->window, &wa)) return;
 	if (wa.override_redirect) return;
 	if (!wintoclient(ev->window)) {
-		if (!(c=calloc(1,sizeof(Client)))) exit(1);
+		c = (Client *) pool_get(&client_pool);
+		geom_add(c);
 		c->win = ev->window;
-		XGetWindowAttributes(dpy,c->win, &attr);
-		c->x = attr.x; c->y = attr.y;
-		c->w = attr.width; c->h = attr.height;
-		if ( (c->x==0) && (c->y==0) && (c->w==sw) && (c->h==sh) ) fsme = True;
-		if (c->y < (topbar ? barheight : 0) +tilegap && showbar) {
-			c->y = (topbar ? barheight : 0) + tilegap;
-			c->x = tilegap;
+		c->drawn.parent = ev->parent;
+		CX(c) = wa.x; CY(c) = wa.y;
+		CW(c) = wa.width; CH(c) = wa.height;
+		if ( (CX(c)==0) && (CY(c)==0) && (CW(c)==sw) && (CH(c)==sh) ) fsme = True;
+		if (CY(c) < (topbar ? barheight : 0) +tilegap && showbar) {
+			CY(c) = (topbar ? barheight : 0) + tilegap;
+			CX(c) = tilegap;
 		}
-		c->tags = (1<<curtag);
+		CTAGS(c) = (1<<curtag);
 		if (XGetTransientForHint(dpy,c->win,&c->parent))
-			c->flags |= SCWM_TRANSIENT;
+			CFLAGS(c) |= SCWM_TRANSIENT;
 		else
 			c->parent = ev->parent;
-		if ( !(XFetchName(dpy,c->win,&c->title)) || c->title == NULL ) {
-			if ( (parent=wintoclient(c->parent)) )
-				c->title = strdup(parent->title);
-			else
-				c->title = strdup(noname_window);
-		}
+		title_fetch(c);
+		sync_setup(c);
 		// get _NET_WM_WINDOW_TYPE - set SCWM_FLOATING
 		XSelectInput(dpy,c->win,PropertyChangeMask | EnterWindowMask);
 		c->next = clients;
+		if (clients) clients->prev = c;
 		clients = c;
+		list_update(c);
+		c->seq = --clientseq;
+		winhash_add(c);
+		grid_add(c);
 		XSetWindowBorderWidth(dpy,c->win,borderwidth);
 		XMapWindow(dpy,c->win);
+		c->drawn.mapped = True;
 		focusclient(c);
 	}
 	if (fsme) fullscreen(NULL);
@@ -569,19 +1392,27 @@ void maprequest(XEvent *e) {
 }
 
 void move(const char *arg) {
-	if (arg[0] == 'L') animate(sw,0);
-	else if (arg[0] == 'R') animate(-sw,0);
-	else if (arg[0] == 'U') animate(0,sh);
-	else if (arg[0] == 'D') animate(0,-sh);
-	else if (arg[0] == 'l') animate(25,0);
-	else if (arg[0] == 'r') animate(-25,0);
-	else if (arg[0] == 'u') animate(0,25);
-	else if (arg[0] == 'd') animate(0,-25);
+	if (arg[0] == 'L') animate(sw,0,1,NULL);
+	else if (arg[0] == 'R') animate(-sw,0,1,NULL);
+	else if (arg[0] == 'U') animate(0,sh,1,NULL);
+	else if (arg[0] == 'D') animate(0,-sh,1,NULL);
+	else if (arg[0] == 'l') animate(25,0,1,NULL);
+	else if (arg[0] == 'r') animate(-25,0,1,NULL);
+	else if (arg[0] == 'u') animate(0,25,1,NULL);
+	else if (arg[0] == 'd') animate(0,-25,1,NULL);
 }
 
 void motionnotify(XEvent *e) {
 	int xdiff, ydiff;
-	while(XCheckTypedEvent(dpy,MotionNotify,e));
+	XEvent next;
+	/* coalesce queued motion without forcing a flush */
+	while (XEventsQueued(dpy,QueuedAfterReading)) {
+		XPeekEvent(dpy,&next);
+		if (next.type != MotionNotify) break;
+		XNextEvent(dpy,e);
+	}
+	/* a pending zoom lands before the drag or an edge pan moves anything */
+	gesture_commit();
 	xdiff = e->xbutton.x_root - start.x_root;
 	ydiff = e->xbutton.y_root - start.y_root;
 if (activeedges) {
@@ -602,94 +1433,206 @@ else if (e->xbutton.y_root < 1) {
 	move("Up");
 	XWarpPointer(dpy,None,root,0,0,0,0,e->xbutton.x_root,4);
 }
-XFlush(dpy);
 holdfocused=False; 
 }
 	if (mousemode == MWMove) {
-		focused->x+=xdiff; focused->y+=ydiff; draw(clients);
+		CX(focused)+=xdiff; CY(focused)+=ydiff;
+		grid_update(focused); draw(clients);
 	}
 	else if (mousemode == MWResize) {
-		focused->w+=xdiff; focused->h+=ydiff; draw(clients);
+		CW(focused)+=xdiff; CH(focused)+=ydiff;
+		grid_update(focused);
+		/* heavy clients only see a real resize every 1/resizerate */
+		if (resizerate && monotonic() - drag.last >= 1.0/resizerate) {
+			drag.c = NULL;
+			draw(clients);
+			drag.c = focused;
+			drag.last = monotonic();
+		}
+		outline(resizeoutline);
 	}
 	else if (mousemode == MDMove) {
-		scrollwindows(clients,xdiff,ydiff);
+		scrollwindows(xdiff,ydiff);
 	}
 	start.x_root+=xdiff; start.y_root+=ydiff;
 }
 
+/* O(1) outside screen mode, which asks the grid */
 Bool neighbors(Client *c) {
+	int l = (targetmode == 't' ? ListTag : ListVisible);
 	previntarg = NULL;
 	nextintarg = NULL;
 	if (!intarget(c,SCWM_ANY)) return False;
-	Client *stack;
-	for (stack = clients; stack && stack != c; stack = stack->next) {
-		if (	(targetmode == 'a') || (targetmode == 's' && onscreen(stack))	||
-				(targetmode == 't' && (stack->tags & (1<<curtag)))				||
-				(targetmode == 'v' && (stack->tags & ~tags_hide))				)
-			previntarg = stack;
-	}
-	for (nextintarg = stack->next;
-		nextintarg && !(
-			(targetmode == 'a') || (targetmode == 's' && onscreen(nextintarg)) ||
-			(targetmode == 't' && (nextintarg->tags & (1<<curtag))) ||
-			(targetmode == 'v' && (nextintarg->tags & ~tags_hide))
-		);
-		nextintarg = nextintarg->next);
+	if (targetmode == 's') {
+		previntarg = grid_step(c,-1,0);
+		nextintarg = grid_step(c,1,0);
+	}
+	else if (targetmode == 'a') {
+		previntarg = c->prev;
+		nextintarg = c->next;
+	}
+	else {
+		list_build(l);
+		previntarg = c->lprev[l];
+		nextintarg = c->lnext[l];
+	}
 	return True;
 }
 
 Bool onscreen(Client *c) {
 	if (!c) return False;
-	if ((c->x + c->w/2) > 0 && (c->x + c->w/2) < sw	&&
-		(c->y + c->h/2) > 0 && (c->y + c->h/2) < sh )
+	if ((CX(c) + CW(c)/2) > 0 && (CX(c) + CW(c)/2) < sw	&&
+		(CY(c) + CH(c)/2) > 0 && (CY(c) + CH(c)/2) < sh )
 		return True;
 	return False;
 }
 
+/* an inverted frame at the pending geometry: drawing it twice erases it;
+ * never over the overview, whose redirected clients would cover it */
+void outline(Bool show) {
+	if (drag.shown) XDrawRectangle(dpy,root,xorgc,drag.x,drag.y,drag.w,drag.h);
+	drag.shown = (show && focused && !ov.active);
+	if (!drag.shown) return;
+	drag.x = CX(focused); drag.y = CY(focused);
+	drag.w = MAX(CW(focused),win_min) + borderwidth;
+	drag.h = MAX(CH(focused),win_min) + borderwidth;
+	XDrawRectangle(dpy,root,xorgc,drag.x,drag.y,drag.w,drag.h);
+}
+
+/* clients are redirected for as long as the overview is available, so
+ * their contents are already off screen and each is drawn scaled from
+ * its own picture */
+void overview_draw() {
+	Client *c;
+	int x, y, w, h;
+	XFillRectangle(dpy,ov.back,setcolor(Background),0,0,sw,sh);
+	for (c = clients; c; c = c->next)
+		if (c != focused) overview_paint(c);
+	/* the focused client goes last, on top and outlined */
+	if (focused && overview_paint(focused) && overview_rect(focused,&x,&y,&w,&h))
+		XDrawRectangle(dpy,ov.back,setcolor(Target),x-1,y-1,w+1,h+1);
+	XCopyArea(dpy,ov.back,ov.win,gc,0,0,sw,sh,0,0);
+}
+
+Bool overview_paint(Client *c) {
+	XTransform t = {{{0,0,0},{0,0,0},{0,0,XDoubleToFixed(1)}}};
+	XRenderPictFormat *fmt;
+	XRenderPictureAttributes pa;
+	XWindowAttributes wa;
+	int x, y, w, h;
+	if (!overview_rect(c,&x,&y,&w,&h)) return False;
+	if (!c->pict) {
+		if (!XGetWindowAttributes(dpy,c->win,&wa)) return False;
+		if (!(fmt=XRenderFindVisualFormat(dpy,wa.visual))) return False;
+		pa.subwindow_mode = IncludeInferiors;
+		c->pict = XRenderCreatePicture(dpy,c->win,fmt,CPSubwindowMode,&pa);
+		XRenderSetPictureFilter(dpy,c->pict,FilterBilinear,NULL,0);
+	}
+	t.matrix[0][0] = XDoubleToFixed((double) c->drawn.w / w);
+	t.matrix[1][1] = XDoubleToFixed((double) c->drawn.h / h);
+	XRenderSetPictureTransform(dpy,c->pict,&t);
+	XRenderComposite(dpy,PictOpSrc,c->pict,None,ov.dst,0,0,0,0,x,y,w,h);
+	return True;
+}
+
+void overview_enter() {
+	if (!ov.win || ov.active) return;
+	animate_stop(True);
+	outline(False);
+	ov.active = True;
+	ov.zoom = 1; ov.x = ov.y = 0;
+	XMapRaised(dpy,ov.win);
+	overview_draw();
+}
+
+/* commit the preview transform to real geometry in one pass each */
+void overview_leave() {
+	if (!ov.active) return;
+	ov.active = False;
+	XUnmapWindow(dpy,ov.win);
+	if (ov.zoom != 1) zoom(ov.zoom,0,0);
+	if ((int) ov.x || (int) ov.y) scrollwindows((int) ov.x,(int) ov.y);
+}
+
+Bool overview_rect(Client *c, int *x, int *y, int *w, int *h) {
+	float z = (CTAGS(c) & tags_stik ? 1 : ov.zoom);
+	float ox = (CTAGS(c) & tags_stik ? 0 : ov.x), oy = (CTAGS(c) & tags_stik ? 0 : ov.y);
+	if ((CTAGS(c) & tags_hide) || !c->drawn.w || !c->drawn.h) return False;
+	*x = CX(c) * z + ox; *y = CY(c) * z + oy;
+	*w = MAX(c->drawn.w * z,1); *h = MAX(c->drawn.h * z,1);
+	return (*x < sw && *y < sh && *x + *w > 0 && *y + *h > 0);
+}
+
+void overview_zoom(float factor, int x, int y) {
+	ov.zoom *= factor;
+	ov.x = (ov.x - x) * factor + x;
+	ov.y = (ov.y - y) * factor + y;
+	overview_draw();
+}
+
 void propertynotify(XEvent *e) {
     XPropertyEvent *ev = &e->xproperty;
-    Client *c,*parent;
+    Client *c;
     if ( !(c=wintoclient(ev->window)) ) return;
     if (ev->atom == XA_WM_NAME) {
-        XFree(c->title); c->title = NULL;
-		if ( !(XFetchName(dpy,c->win,&c->title)) || c->title == NULL ) {
-			if ( (parent=wintoclient(c->parent)) )
-				c->title = strdup(parent->title);
-			else
-				c->title = strdup(noname_window);
-		}
-        draw(clients);
+		title_fetch(c);
+        drawbar();
     }
     else if (ev->atom == XA_WM_HINTS) {
         XWMHints *hint;
         if ( (hint=XGetWMHints(dpy,c->win)) && (hint->flags & XUrgencyHint) )
-			tags_urg |= c->tags;
-        draw(clients);
+			tags_urg |= CTAGS(c);
+		if (hint) XFree(hint);
+        drawbar();
     }
 }
 
+void *pool_get(Pool *p) {
+	void *o;
+	char *slab;
+	int i;
+	if (!p->free) {
+		if (!(slab=calloc(POOL_SLAB,p->size))) exit(1);
+		for (i = POOL_SLAB - 1; i >= 0; i--) {
+			*(void **)(slab + i*p->size) = p->free;
+			p->free = slab + i*p->size;
+		}
+	}
+	o = p->free;
+	p->free = *(void **)o;
+	memset(o,0,p->size);
+	if (++p->live > p->peak) p->peak = p->live;
+	return o;
+}
+
+void pool_put(Pool *p, void *o) {
+	*(void **)o = p->free;
+	p->free = o;
+	p->live--;
+}
+
 void quit(const char *arg) {
 	running = False;
 }
 
 GC setcolor(int col) {
-	XAllocNamedColor(dpy,cmap,colors[col],&color,&color);
-	XSetForeground(dpy,gc,color.pixel);
+	XSetForeground(dpy,gc,pixels[col]);
 	return gc;
 }
 
-void scrollwindows(Client *stack, int x, int y) {
-	while (stack) {
-		if (holdfocused && focused && stack==focused) {
-			stack = stack->next;
-			continue;
-		}
-		if (!(stack->tags & tags_stik)) {
-			stack->x+=x;
-			stack->y+=y;
-		}
-		stack = stack->next;
+void scrollwindows(int x, int y) {
+	int i, m, n = geom.n, stik = tags_stik;
+	int hold = (holdfocused && focused ? focused->id : -1);
+	int *restrict gx = geom.x, *restrict gy = geom.y;
+	const int *restrict gt = geom.tags;
+	/* branchless so the pan vectorizes: m is all ones for clients that move */
+	for (i = 0; i < n; i++) {
+		m = -(!(gt[i] & stik) & (i != hold));
+		gx[i] += x & m;
+		gy[i] += y & m;
 	}
+	for (i = 0; i < n; i++) grid_update(geom.client[i]);
+	if (canvasmode) canvas_pan(x,y);
 	checkpoint_update(x,y,1);
 	draw(clients);
 }
@@ -698,46 +1641,193 @@ void spawn(const char *arg) {
 	system(arg);
 }
 
-void status(char *msg) {
-	char *col = (char *) calloc(8,sizeof(char));
-	char *t,*c = msg;
-	int l;
+void status(StatusSource *src, char *msg) {
+	StatusList *old = &src->list[src->cur], *new = &src->list[!src->cur];
+	StatusOp *op;
+	unsigned long pixel = pixels[Default];
+	unsigned int hash;
+	char *c, *t;
+	int i, len;
 #ifdef __SCWM_ICONS_H__
 	int arg;
 #endif
-	XColor color;
-	statuswidth = 0;
-	XFillRectangle(dpy,sbar,setcolor(Background),0,0,sw/2,barheight);
-	setcolor(Default);
-	while(*c != '\n') {
+	/* an unchanged line costs one hash and compare */
+	if (!(t=strchr(msg,'\n'))) t = msg + strlen(msg);
+	len = MIN(t - msg, STATUS_TEXT);
+	hash = strhash(msg,len);
+	if (hash == old->hash && len == old->len && !memcmp(msg,old->text,len)) return;
+	/* compile to ops */
+	memcpy(new->text,msg,len);
+	new->text[len] = '\0';
+	new->hash = hash; new->len = len; new->n = 0; new->width = 0;
+	c = new->text; t = c + len;
+	while (c < t && new->n < STATUS_OPS) {
 		if (*c == '{') {
-			if (*(++c) == '#') {
-				strncpy(col,c,7);
-				XAllocNamedColor(dpy,cmap,col,&color,&color);
-				XSetForeground(dpy,gc,color.pixel);
-			}
+			if (*(++c) == '#')
+				pixel = hexpixel(c);
 #ifdef __SCWM_ICONS_H__
-			else if ( (*c == 'i') && (sscanf(c,"i %d",&arg) == 1) ) {
-				XFillRectangle(dpy,iconbuf,bgc,0,0,iconwidth,iconheight);
-				XDrawPoints(dpy,iconbuf,gc,icons[arg].pts,icons[arg].n,CoordModeOrigin);
-				XCopyArea(dpy,iconbuf,sbar,gc,0,0,iconwidth,iconheight,statuswidth,(barheight-iconheight)/2);
-				statuswidth+=iconwidth+1;
+			else if ( (*c == 'i') && (sscanf(c,"i %d",&arg) == 1) &&
+					arg >= 0 && arg < sizeof(icons)/sizeof(icons[0]) ) {
+				op = &new->op[new->n++];
+				op->type = 'i'; op->pixel = pixel;
+				op->arg = arg; op->len = 0; op->hash = arg;
+				op->x = new->width; op->w = iconwidth+1;
+				new->width += op->w;
 			}
 #endif /* __SCWM_ICONS_H__ */
-			c = strchr(c,'}')+1;
+			if (!(c=strchr(c,'}'))) break;
+			c++;
 		}
 		else {
-			if ((t=strchr(c,'{'))==NULL) t=strchr(c,'\n');
-			l = (t == NULL ? 0 : t-c);
-			if (l) {
-				XDrawString(dpy,sbar,gc,statuswidth,fontheight,c,l);
-				statuswidth+=XTextWidth(fontstruct,c,l);
-			}
-			c+=l;
+			for (i = 0; c+i < t && c[i] != '{'; i++);
+			op = &new->op[new->n++];
+			op->type = 't'; op->pixel = pixel;
+			op->arg = c - new->text; op->len = i; op->hash = strhash(c,i);
+			op->x = new->width; op->w = XTextWidth(fontstruct,c,i);
+			new->width += op->w;
+			c += i;
 		}
 	}
-	free(col);
-	draw(clients);
+	status_paint(src);
+}
+
+/* compile the newest shared snapshot straight to ops, no text parsing */
+void status_shm(StatusSource *src) {
+	StatusList *new = &src->list[!src->cur];
+	ShmStatus *shm = src->shm;
+	ShmSnapshot snap;
+	ShmSegment *seg;
+	StatusOp *op;
+	unsigned int head;
+	int i, len, pos = 0;
+	do {
+		if (!(head=__atomic_load_n(&shm->head,__ATOMIC_ACQUIRE))) return;
+		memcpy(&snap,&shm->slot[(head-1) % SHMSTATUS_SLOTS],sizeof(snap));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&shm->head,__ATOMIC_ACQUIRE) - head >= SHMSTATUS_SLOTS - 1);
+	new->hash = 0; new->len = -1; new->n = 0; new->width = 0;
+	for (i = 0; i < MIN(snap.n,SHMSTATUS_SEGS) && new->n < STATUS_OPS - 1; i++) {
+		seg = &snap.seg[i];
+#ifdef __SCWM_ICONS_H__
+		if (seg->icon >= 0 && seg->icon < sizeof(icons)/sizeof(icons[0])) {
+			op = &new->op[new->n++];
+			op->type = 'i'; op->pixel = rgbpixel(seg->rgb);
+			op->arg = seg->icon; op->len = 0; op->hash = seg->icon;
+			op->x = new->width; op->w = iconwidth+1;
+			new->width += op->w;
+		}
+#endif /* __SCWM_ICONS_H__ */
+		seg->text[SHMSTATUS_TEXT-1] = '\0';
+		if (!(len=MIN(strlen(seg->text),STATUS_TEXT - pos))) continue;
+		memcpy(new->text+pos,seg->text,len);
+		op = &new->op[new->n++];
+		op->type = 't'; op->pixel = rgbpixel(seg->rgb);
+		op->arg = pos; op->len = len; op->hash = strhash(seg->text,len);
+		op->x = new->width; op->w = XTextWidth(fontstruct,seg->text,len);
+		new->width += op->w;
+		pos += len;
+	}
+	status_paint(src);
+}
+
+/* map a channel for a command about to be started; the child inherits
+ * both descriptors, the name is gone as soon as it is opened */
+void status_shm_open(StatusSource *src) {
+	char name[32];
+	int fd;
+	snprintf(name,sizeof(name),"/scrollwm-%d-%d",(int) getpid(),(int) (src - sources));
+	if ((fd=shm_open(name,O_RDWR | O_CREAT | O_EXCL,0600)) < 0) return;
+	shm_unlink(name);
+	fcntl(fd,F_SETFD,0);	/* shm_open sets close-on-exec */
+	if (ftruncate(fd,sizeof(ShmStatus)) ||
+			(src->shm=mmap(NULL,sizeof(ShmStatus),PROT_READ | PROT_WRITE,
+			MAP_SHARED,fd,0)) == MAP_FAILED) {
+		src->shm = NULL;
+		close(fd);
+		return;
+	}
+	if ((src->efd=eventfd(0,EFD_NONBLOCK)) < 0) {
+		munmap(src->shm,sizeof(ShmStatus));
+		src->shm = NULL;
+		close(fd);
+		return;
+	}
+	src->shm->magic = SHMSTATUS_MAGIC;
+	src->fd = fd;	/* closed once the command has started */
+}
+
+/* repaint only ops that differ from the previous list */
+void status_paint(StatusSource *src) {
+	StatusList *old = &src->list[src->cur], *new = &src->list[!src->cur];
+	StatusOp *op, *o;
+	int i, changed = 0;
+	for (i = 0; i < new->n; i++) {
+		op = &new->op[i];
+		o = (i < old->n ? &old->op[i] : NULL);
+		if (o && o->type == op->type && o->pixel == op->pixel &&
+				o->x == op->x && o->w == op->w && o->hash == op->hash &&
+				o->len == op->len && (op->type == 'i' ? o->arg == op->arg :
+				!memcmp(old->text+o->arg,new->text+op->arg,op->len)))
+			continue;
+		XFillRectangle(dpy,src->pix,setcolor(Background),op->x,0,op->w,barheight);
+		XSetForeground(dpy,gc,op->pixel);
+		if (op->type == 't')
+			XDrawString(dpy,src->pix,gc,op->x,fontheight,new->text+op->arg,op->len);
+#ifdef __SCWM_ICONS_H__
+		else {
+			/* bitmap ones in the op colour, zeros in the background */
+			XSetForeground(dpy,bgc,op->pixel);
+			XCopyPlane(dpy,iconmask[op->arg],src->pix,bgc,0,0,iconwidth,iconheight,
+					op->x,(barheight-iconheight)/2,1);
+		}
+#endif /* __SCWM_ICONS_H__ */
+		changed++;
+	}
+	src->cur = !src->cur;
+	src->width = MIN(new->width,sw/2);
+	if (changed) src->gen++;
+	if (changed || new->width != old->width) drawbar();
+}
+
+/* drain the fd; returns False at end of input or on a real error */
+Bool status_read(StatusSource *src) {
+	const unsigned int mask = STATUS_RING - 1;
+	unsigned int i, start, len;
+	int n;
+	for (;;) {
+		if (src->tail - src->head == STATUS_RING) {
+			src->head = src->tail;
+			src->skip = True;
+		}
+		n = MIN(STATUS_RING - (src->tail - src->head), STATUS_RING - (src->tail & mask));
+		if ((n=read(src->fd,src->ring + (src->tail & mask),n)) == 0) return False;
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK);
+		src->tail += n;
+		for (i = src->tail; i != src->head; i--) if (src->ring[(i-1) & mask] == '\n') break;
+		if (i == src->head) continue;
+		if (src->skip) {
+			/* the tail of an overlong line is not a line */
+			while (src->ring[src->head++ & mask] != '\n');
+			src->skip = False;
+			if (src->head == i) continue;
+		}
+		/* newest complete line wins, older ones are dropped unseen */
+		for (start = i - 1; start != src->head && src->ring[(start-1) & mask] != '\n'; start--);
+		len = MIN(i - 1 - start, STATUS_TEXT - 1);
+		for (n = 0; n < len; n++) src->line[n] = src->ring[(start+n) & mask];
+		src->line[len] = '\n';
+		src->line[len+1] = '\0';
+		src->pending = True;
+		src->head = i;
+	}
+}
+
+/* FNV-1a */
+unsigned int strhash(const char *s, int len) {
+	unsigned int h = 2166136261u;
+	while (len-- > 0) h = (h ^ (unsigned char) *s++) * 16777619u;
+	return h;
 }
 
 void shift(const char *arg) {
@@ -753,10 +1843,20 @@ void shift(const char *arg) {
 Bool swap(Client *a, Client *b) {
 	if (!a || !b) return False;
 	Client t;
+	Shadow d;
+	int tags;
+	winhash_del(a); winhash_del(b);
 	t.title = a->title; a->title=b->title; b->title = t.title;
-//	t.tlen = a->tlen; a->tlen=b->tlen; b->tlen = t.tlen;
-	t.tags = a->tags; a->tags=b->tags; b->tags = t.tags;
+	t.tlen = a->tlen; a->tlen=b->tlen; b->tlen = t.tlen;
+	t.tchars = a->tchars; a->tchars=b->tchars; b->tchars = t.tchars;
+	t.twidth = a->twidth; a->twidth=b->twidth; b->twidth = t.twidth;
+	t.tgen = a->tgen; a->tgen=b->tgen; b->tgen = t.tgen;
+	t.pict = a->pict; a->pict=b->pict; b->pict = t.pict;
+	tags = CTAGS(a); CTAGS(a)=CTAGS(b); CTAGS(b) = tags;
 	t.win = a->win; a->win=b->win; b->win = t.win;
+	d = a->drawn; a->drawn=b->drawn; b->drawn = d;
+	winhash_add(a); winhash_add(b);
+	list_update(a); list_update(b);
 	return True;
 }
 
@@ -781,15 +1881,14 @@ void switcher(const char *arg) {
 				setcolor(Target);
 				selclient = stack;
 			}
-			else if (stack->flags & tags_hide) setcolor(Hidden);
-			else if (stack->flags & tags_stik) setcolor(Sticky);
+			else if (CFLAGS(stack) & tags_hide) setcolor(Hidden);
+			else if (CFLAGS(stack) & tags_stik) setcolor(Sticky);
 			else if (onscreen(stack)) setcolor(Title);
 			else setcolor(Default);
 			XDrawString(dpy,bar,gc,10,(n+3)*barheight,
-				stack->title,strlen(stack->title));
+				stack->title,stack->tchars);
 		}
-		draw(clients);
-		XFlush(dpy);
+		drawbar();
 		XMaskEvent(dpy,KeyPress, &e);
 		ev = &e.xkey;
 		ks = XkbKeycodeToKeysym(dpy,(KeyCode)ev->keycode,0,0);
@@ -811,19 +1910,99 @@ void switcher(const char *arg) {
 	XMoveResizeWindow(dpy,bar,0,(showbar?(topbar?0:sh-barheight):-barheight),sw,barheight);
 }
 
+/* the client has caught up with the last configure: release held sizes */
+void sync_alarm(XEvent *e) {
+	XSyncAlarmNotifyEvent *ev = (XSyncAlarmNotifyEvent *) e;
+	Client *c;
+	for (c = clients; c; c = c->next) if (c->drawn.alarm == ev->alarm) break;
+	if (!c || !c->drawn.syncdue) return;
+	c->drawn.syncdue = 0;
+	syncwaiting--;
+	draw(clients);
+}
+
+/* give up on clients that did not answer within synctimeout */
+void sync_expire() {
+	double now = monotonic();
+	Client *c;
+	syncdue = 0;
+	for (c = clients; c; c = c->next) {
+		if (!c->drawn.syncdue) continue;
+		if (c->drawn.syncdue <= now) {
+			c->drawn.syncdue = 0;
+			syncwaiting--;
+		}
+		else if (!syncdue || c->drawn.syncdue < syncdue)
+			syncdue = c->drawn.syncdue;
+	}
+	draw(clients);
+}
+
+/* arm the alarm, then tell the client which value to set once it has
+ * handled the configure that follows */
+void sync_request(Client *c) {
+	Shadow *d = &c->drawn;
+	XSyncAlarmAttributes aa;
+	XEvent ev;
+	d->serial++;
+	XSyncIntsToValue(&aa.trigger.wait_value,d->serial,0);
+	XSyncChangeAlarm(dpy,d->alarm,XSyncCAValue,&aa);
+	ev.type = ClientMessage;
+	ev.xclient.window = c->win;
+	ev.xclient.message_type = atoms[WMProtocols];
+	ev.xclient.format = 32;
+	ev.xclient.data.l[0] = atoms[NetSyncRequest];
+	ev.xclient.data.l[1] = CurrentTime;
+	ev.xclient.data.l[2] = d->serial;
+	ev.xclient.data.l[3] = 0;
+	ev.xclient.data.l[4] = 0;
+	XSendEvent(dpy,c->win,False,NoEventMask,&ev);
+	d->syncdue = monotonic() + synctimeout/1000.0;
+	if (!syncwaiting++ || d->syncdue < syncdue) syncdue = d->syncdue;
+}
+
+void sync_setup(Client *c) {
+	Atom *protos, type;
+	unsigned char *prop = NULL;
+	unsigned long n, extra;
+	XSyncAlarmAttributes aa;
+	int i, count, format;
+	Bool found = False;
+	if (syncevent < 0) return;
+	if (XGetWMProtocols(dpy,c->win,&protos,&count)) {
+		for (i = 0; i < count; i++) if (protos[i] == atoms[NetSyncRequest]) found = True;
+		XFree(protos);
+	}
+	if (!found) return;
+	if (XGetWindowProperty(dpy,c->win,atoms[NetSyncCounter],0,1,False,XA_CARDINAL,
+			&type,&format,&n,&extra,&prop) == Success && prop && n)
+		c->drawn.counter = *(unsigned long *) prop;
+	if (prop) XFree(prop);
+	if (!c->drawn.counter) return;
+	aa.trigger.counter = c->drawn.counter;
+	aa.trigger.value_type = XSyncAbsolute;
+	aa.trigger.test_type = XSyncPositiveComparison;
+	XSyncIntsToValue(&aa.trigger.wait_value,0,0);
+	XSyncIntToValue(&aa.delta,0);
+	aa.events = True;
+	c->drawn.alarm = XSyncCreateAlarm(dpy,XSyncCACounter | XSyncCAValueType |
+			XSyncCATestType | XSyncCAValue | XSyncCADelta | XSyncCAEvents,&aa);
+}
+
 void tag(const char *arg) {
 	curtag = arg[0] - 49;
 	tags_urg &= ~(1<<curtag);
+	lvalid[ListTag] = False;
 	Client *c, *t=NULL;
 	if (tagpoints)
 		checkpoint(arg);
 	else if (clients) {
-		for (c = clients; c; c = c->next) if (c->tags & (1<<curtag)) {
+		for (c = clients; c; c = c->next) if (CTAGS(c) & (1<<curtag)) {
 			if (!t) t = c;
 			XRaiseWindow(dpy,c->win);
 		}
 		XRaiseWindow(dpy,bar);
-		if (! (focused->tags & (1<<curtag)) && t ) focused = t;
+		if (! (CTAGS(focused) & (1<<curtag)) && t ) focused = t;
 		focusclient(focused);
 	}
 	draw(clients);
@@ -845,6 +2024,7 @@ void tagconfig(const char *arg) {
 		if (i != curtag) tags_hide |= (1<<i);
 		else tags_hide &= ~(1<<i);
 	}
+	lvalid[ListVisible] = False;
 	if (showbar) XMoveWindow(dpy,bar,0,(topbar ? 0 : sh - barheight));
 	else XMoveWindow(dpy,bar,0,(topbar ? -barheight: sh));
 	if (autoretile) tile(curtile);
@@ -853,15 +2033,15 @@ void tagconfig(const char *arg) {
 
 void target(const char *arg) {
 	targetmode = arg[0];
-	draw(clients);
+	drawbar();
 }
 
 void tile_one(Client *stack) {
 	while (!intarget(stack,SCWM_TILED)) stack=stack->next;
-	stack->x = tilegap;
-	stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-	stack->w = sw - 2*(tilegap + borderwidth);
-	stack->h = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
+	CX(stack) = tilegap;
+	CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+	CW(stack) = sw - 2*(tilegap + borderwidth);
+	CH(stack) = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
 	slave = stack;
 }
 
@@ -869,19 +2049,19 @@ void tile_bstack(Client *stack, int count) {
 	while (!intarget(stack,SCWM_TILED)) stack=stack->next;
 	int w = (sw - tilegap)/(count-1);
 	int h = (sh - (showbar && topbar ? barheight : 0) - tilegap)/2 - (tilegap + 2*borderwidth);
-	stack->x = tilegap;
-	stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-	stack->w = sw - 2*(tilegap + borderwidth);
-	stack->h = h + tilebias;
+	CX(stack) = tilegap;
+	CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+	CW(stack) = sw - 2*(tilegap + borderwidth);
+	CH(stack) = h + tilebias;
 	int i=0;
 	while ((stack=stack->next)) {
 		if (!intarget(stack,SCWM_TILED)) continue;
-		stack->x = tilegap + i*w;
-		stack->y = (showbar && topbar ? barheight : 0) + h + 2*(tilegap+borderwidth) + tilebias;
-		stack->w = MAX(w - tilegap - 2*borderwidth,win_min);
-		stack->h = h - tilebias;
+		CX(stack) = tilegap + i*w;
+		CY(stack) = (showbar && topbar ? barheight : 0) + h + 2*(tilegap+borderwidth) + tilebias;
+		CW(stack) = MAX(w - tilegap - 2*borderwidth,win_min);
+		CH(stack) = h - tilebias;
 		i++;
-		if (!stack->next) stack->w = MAX(sw - stack->x - tilegap - 2*borderwidth,win_min);
+		if (!stack->next) CW(stack) = MAX(sw - CX(stack) - tilegap - 2*borderwidth,win_min);
 	}
 }
 
@@ -892,10 +2072,10 @@ void tile_flow(Client *stack, int count) {
 			stack = stack->next;
 			continue;
 		}
-		stack->x = tilegap + sw*(x++);
-		stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-		stack->w = sw - 2*(tilegap + borderwidth);
-		stack->h = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
+		CX(stack) = tilegap + sw*(x++);
+		CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+		CW(stack) = sw - 2*(tilegap + borderwidth);
+		CH(stack) = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
 		stack = stack->next;
 	}
 }
@@ -916,40 +2096,40 @@ void tile_rstack(Client *stack, int count) {
 	while (!intarget(stack,SCWM_TILED)) stack=stack->next;
 	int w = (sw - tilegap)/2 - (tilegap + 2*borderwidth);
 	int h = (sh - (showbar && topbar ? barheight : 0) - tilegap)/(count-1);
-	stack->x = tilegap;
-	stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-	stack->w = w + tilebias;
-	stack->h = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
+	CX(stack) = tilegap;
+	CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+	CW(stack) = w + tilebias;
+	CH(stack) = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
 	int i=0;
 	while ((stack=stack->next)) {
 		if (!intarget(stack,SCWM_TILED)) continue;
-		stack->x = w + 2*(tilegap+borderwidth) + tilebias;
-		stack->y = (showbar && topbar ? barheight : 0) + tilegap + i*h;
-		stack->w = w - tilebias;
-		stack->h = MAX(h - tilegap - 2*borderwidth,win_min);
+		CX(stack) = w + 2*(tilegap+borderwidth) + tilebias;
+		CY(stack) = (showbar && topbar ? barheight : 0) + tilegap + i*h;
+		CW(stack) = w - tilebias;
+		CH(stack) = MAX(h - tilegap - 2*borderwidth,win_min);
 		i++;
 		if (!stack->next)
-			stack->h = MAX(sh - (showbar ? (topbar ? 0: barheight) : 0)
-				- stack->y - tilegap - 2*borderwidth,win_min);
+			CH(stack) = MAX(sh - (showbar ? (topbar ? 0: barheight) : 0)
+				- CY(stack) - tilegap - 2*borderwidth,win_min);
 	}
 }
 
 void tile_ttwm(Client *stack, int count) {
 	while (!intarget(stack,SCWM_TILED)) stack=stack->next;
 	int w = (sw - tilegap)/2 - (tilegap + 2*borderwidth);
-	stack->x = tilegap;
-	stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-	stack->w = w + tilebias;
-	stack->h = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
+	CX(stack) = tilegap;
+	CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+	CW(stack) = w + tilebias;
+	CH(stack) = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
 	int i=0;
 	XRaiseWindow(dpy,stack->next->win);
 	XRaiseWindow(dpy,bar);
 	while ((stack=stack->next)) {
 		if (!intarget(stack,SCWM_TILED)) continue;
-		stack->x = w + 2*(tilegap+borderwidth) + tilebias;
-		stack->y = (showbar && topbar ? barheight : 0) + tilegap;
-		stack->w = w - tilebias;
-		stack->h = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
+		CX(stack) = w + 2*(tilegap+borderwidth) + tilebias;
+		CY(stack) = (showbar && topbar ? barheight : 0) + tilegap;
+		CW(stack) = w - tilebias;
+		CH(stack) = sh - (showbar ? barheight: 0) - 2*(tilegap + borderwidth);
 		i++;
 	}
 }
@@ -961,7 +2141,12 @@ void tile(const char *arg) {
 	for (c = clients; c; c = c->next)
 		if (intarget(c,SCWM_TILED)) i++;
 	if (i == 0) return;
-	else if (i == 1) { tile_one(clients); draw(clients); return; }
+	else if (i == 1) {
+		tile_one(clients);
+		for (c = clients; c; c = c->next) grid_update(c);
+		draw(clients);
+		return;
+	}
 	if (arg[0] == 't') tile_ttwm(clients,i);
 	else if (arg[0] == 'r') tile_rstack(clients,i);
 	else if (arg[0] == 'b') tile_bstack(clients,i);
@@ -980,32 +2165,83 @@ void tile(const char *arg) {
 			tile(curtile);
 	}
 	else return;
+	for (c = clients; c; c = c->next) grid_update(c);
 	draw(clients);
 }
 
+void title_fetch(Client *c) {
+	char *name = NULL;
+	Client *parent;
+	if (XFetchName(dpy,c->win,&name) && name) {
+		title_set(c,name);
+		XFree(name);
+	}
+	else if ( (parent=wintoclient(c->parent)) && parent != c )
+		title_set(c,parent->title);
+	else
+		title_set(c,noname_window);
+}
+
+void title_free(Client *c) {
+	int i;
+	if (!c->title) return;
+	for (i = 0; title_pool[i].size != c->tlen; i++);
+	pool_put(&title_pool[i],c->title);
+	c->title = NULL;
+	c->tlen = 0;
+}
+
+/* reuse the current buffer in place when the new title fits */
+void title_set(Client *c, const char *name) {
+	int i, l = strlen(name);
+	if (l >= TITLE_MAX) l = TITLE_MAX - 1;
+	if (l >= c->tlen) {
+		title_free(c);
+		for (i = 0; title_pool[i].size <= l; i++);
+		c->title = (char *) pool_get(&title_pool[i]);
+		c->tlen = title_pool[i].size;
+	}
+	memcpy(c->title,name,l);
+	c->title[l] = '\0';
+	c->tchars = l;
+	c->twidth = XTextWidth(fontstruct,c->title,l);
+	c->tgen = ++titlegen;
+}
+
 void toggletag(const char *arg) {
 	if (!focused) return;
 	int t = arg[0] - 49;
-	focused->tags = focused->tags ^ (1<<t);
+	CTAGS(focused) = CTAGS(focused) ^ (1<<t);
+	list_update(focused);
 	draw(clients);
 }
 
 void unmanage(Client *c) {
-	Client *t;
-//	Bool retile = (autoretile ? !(c->flags & ~SCWM_TILED) : False);
+	int i;
+//	Bool retile = (autoretile ? !(CFLAGS(c) & ~SCWM_TILED) : False);
 	if (c == focused) {
 		neighbors(c);
 		if (nextintarg) focusclient(nextintarg);
 		else if (previntarg) focusclient(previntarg);
 		else focusclient(NULL);
 	}
-	if (c == clients) clients = c->next;
-	else {
-		for (t = clients; t && t->next != c; t = t->next);
-		t->next = c->next;
+	if (c->prev) c->prev->next = c->next;
+	else clients = c->next;
+	if (c->next) c->next->prev = c->prev;
+	for (i = 0; i < LASTList; i++) if (lvalid[i]) list_unlink(c,i);
+	if (gesture.c == c) gesture.active = False;
+	if (drag.c == c) {
+		outline(False);
+		drag.c = NULL;
 	}
-	XFree(c->title);
-	free(c);
+	winhash_del(c);
+	grid_del(c);
+	geom_del(c);
+	title_free(c);
+	if (c->pict) XRenderFreePicture(dpy,c->pict);
+	if (c->drawn.alarm) XSyncDestroyAlarm(dpy,c->drawn.alarm);
+	if (c->drawn.syncdue) syncwaiting--;
+	pool_put(&client_pool,c);
 	c = NULL;
 	if (!focused) {
 		focused=clients;
@@ -1018,42 +2254,79 @@ void unmanage(Client *c) {
 void unmapnotify(XEvent *e) {
 	Client *c;
 	if (!(c=wintoclient(e->xunmap.window))) return;
-	if (!e->xunmap.send_event) unmanage(c);
+	if (c->drawn.unmaps) {
+		c->drawn.unmaps--;
+		return;
+	}
+	if (e->xunmap.send_event) return;
+	if (canvasmode && c->drawn.parent == canvas)
+		XReparentWindow(dpy,c->win,root,CX(c),CY(c));
+	unmanage(c);
 }
 
 void window(const char *arg) {
 	if (arg[0] == 'm') mousemode = MWMove;
-	else if (arg[0] == 'r') mousemode = MWResize;
-	else if (arg[0] == 'g') zoomwindow(focused,1.1,start.x_root,start.y_root);
-	else if (arg[0] == 's') zoomwindow(focused,.92,start.x_root,start.y_root);
+	else if (arg[0] == 'r') {
+		mousemode = MWResize;
+		drag.c = focused;
+	}
+	else if (arg[0] == 'g' && focused) gesture_add(focused,1.1,start.x_root,start.y_root);
+	else if (arg[0] == 's' && focused) gesture_add(focused,.92,start.x_root,start.y_root);
 	else if (arg[0] == 'z') {
-		focused->x=-borderwidth; focused->w=sw;
-		focused->y=(showbar && topbar ? barheight : 0)-borderwidth;
-		focused->h=(showbar ? sh-barheight : sh) + borderwidth;
+		CX(focused)=-borderwidth; CW(focused)=sw;
+		CY(focused)=(showbar && topbar ? barheight : 0)-borderwidth;
+		CH(focused)=(showbar ? sh-barheight : sh) + borderwidth;
+		grid_update(focused);
 	}
 }
 
 Client *wintoclient(Window w) {
 	Client *c;
-	for (c = clients; c && c->win != w; c = c->next);
-	if (c) return c;
-	else return NULL;
+	for (c = winhash[WINHASH_KEY(w)]; c && c->win != w; c = c->hnext);
+	return c;
+}
+
+void winhash_add(Client *c) {
+	Client **h = &winhash[WINHASH_KEY(c->win)];
+	c->hnext = *h;
+	*h = c;
+}
+
+void winhash_del(Client *c) {
+	Client **h;
+	for (h = &winhash[WINHASH_KEY(c->win)]; *h && *h != c; h = &(*h)->hnext);
+	if (*h) *h = c->hnext;
+	c->hnext = NULL;
 }
 
 void zoomwindow(Client *c, float factor, int x, int y) {
-	c->w *= factor; c->h *= factor;
-	if (c->w < zoom_min) c->w = zoom_min;
-	if (c->h < zoom_min) c->h = zoom_min;
-	c->x = (c->x-x) * factor + x;
-	c->y = (c->y-y) * factor + y;
+	CW(c) *= factor; CH(c) *= factor;
+	if (CW(c) < zoom_min) CW(c) = zoom_min;
+	if (CH(c) < zoom_min) CH(c) = zoom_min;
+	CX(c) = (CX(c)-x) * factor + x;
+	CY(c) = (CY(c)-y) * factor + y;
+	grid_update(c);
 }
 
 
-void zoom(Client *stack, float factor, int x, int y) {
-	while (stack) {
-		if (!(stack->tags & tags_stik)) zoomwindow(stack,factor,x,y);
-		stack = stack->next;
+void zoom(float factor, int x, int y) {
+	int i, n = geom.n, stik = tags_stik;
+	int *restrict gx = geom.x, *restrict gy = geom.y;
+	float *restrict gw = geom.w, *restrict gh = geom.h;
+	const int *restrict gt = geom.tags;
+	float f, m, w, h;
+	/* sticky clients get a factor of one and a floor of zero rather than
+	 * a branch, so a zoom leaves them exactly as they were */
+	for (i = 0; i < n; i++) {
+		f = (gt[i] & stik ? 1 : factor);
+		m = (gt[i] & stik ? 0 : zoom_min);
+		w = gw[i] * f; h = gh[i] * f;
+		gw[i] = (w < m ? m : w);
+		gh[i] = (h < m ? m : h);
+		gx[i] = (gx[i]-x) * f + x;
+		gy[i] = (gy[i]-y) * f + y;
 	}
+	for (i = 0; i < n; i++) grid_update(geom.client[i]);
 	checkpoint_update(x,y,factor);
 	draw(clients);
 }
@@ -1068,8 +2341,43 @@ int xerror(Display *d, XErrorEvent *ev) {
 
 
 int main(int argc, const char **argv) {
-	if (argc > 1) inpipe = popen(argv[1],"r");
-	else inpipe = stdin;
+	int i, j, n;
+	char num[16];
+	StatusSource *src;
+	/* each argument is a status command, optionally prefixed with "rate:" */
+	for (i = 1; i < argc && nsources < STATUS_SOURCES; i++) {
+		src = &sources[nsources];
+		src->rate = statusrate;
+		if (sscanf(argv[i],"%d:%n",&j,&n) == 1 && n && j > 0) {
+			src->rate = j;
+			argv[i] += n;
+		}
+		src->efd = -1;
+		if (shmstatus) status_shm_open(src);
+		/* only this command sees the channel in its environment */
+		if (src->shm) {
+			snprintf(num,sizeof(num),"%d",src->fd); setenv("SCROLLWM_STATUS_SHM",num,1);
+			snprintf(num,sizeof(num),"%d",src->efd); setenv("SCROLLWM_STATUS_FD",num,1);
+		}
+		if ((src->pipe=popen(argv[i],"r"))) nsources++;
+		unsetenv("SCROLLWM_STATUS_SHM");
+		unsetenv("SCROLLWM_STATUS_FD");
+		if (src->shm) {
+			close(src->fd);
+			fcntl(src->efd,F_SETFD,FD_CLOEXEC);
+		}
+		if (!src->pipe && src->shm) {
+			munmap(src->shm,sizeof(ShmStatus));
+			close(src->efd);
+			src->shm = NULL;
+		}
+	}
+	if (argc < 2) {
+		sources[0].efd = -1;
+		sources[0].pipe = stdin;
+		sources[0].rate = statusrate;
+		nsources = 1;
+	}
 	/* init X */
     if(!(dpy = XOpenDisplay(0x0))) return 1;
 	scr = DefaultScreen(dpy);
@@ -1086,21 +2394,71 @@ int main(int argc, const char **argv) {
 	fontheight = fontstruct->ascent+1;
 	barheight = fontstruct->ascent+fontstruct->descent+2;
 	gc = XCreateGC(dpy,root,GCFont,&val);
+	val.function = GXinvert;
+	val.subwindow_mode = IncludeInferiors;
+	val.line_width = 2;
+	xorgc = XCreateGC(dpy,root,GCFunction|GCSubwindowMode|GCLineWidth,&val);
+	char *atom_names[LASTAtom] = {
+		[WMProtocols]	= "WM_PROTOCOLS",
+		[WMDelete]		= "WM_DELETE_WINDOW",
+		[NetSyncRequest]	= "_NET_WM_SYNC_REQUEST",
+		[NetSyncCounter]	= "_NET_WM_SYNC_REQUEST_COUNTER",
+	};
+	XInternAtoms(dpy,atom_names,LASTAtom,False,atoms);
+	if (!(syncresize && XSyncQueryExtension(dpy,&syncevent,&i) && XSyncInitialize(dpy,&i,&j)))
+		syncevent = -1;
+	XColor color;
+	for (i = 0; i < LASTColor; i++) {
+		XAllocNamedColor(dpy,cmap,colors[i],&color,&color);
+		pixels[i] = color.pixel;
+	}
 	/* buffers and windows */
 	bar = XCreateSimpleWindow(dpy,root,0,(topbar ? 0 : sh-barheight),sw,barheight,0,0,0);
 	buf = XCreatePixmap(dpy,root,sw,barheight,DefaultDepth(dpy,scr));
-	sbar = XCreatePixmap(dpy,root,sw/2,barheight,DefaultDepth(dpy,scr));
+	for (i = 0; i < nsources; i++)
+		sources[i].pix = XCreatePixmap(dpy,root,sw/2,barheight,DefaultDepth(dpy,scr));
+	XFillRectangle(dpy,buf,setcolor(Background),0,0,sw,barheight);
+	for (i = 0; tag_name[i] && i < 32; i++)
+		tagwidth[i] = XTextWidth(fontstruct,tag_name[i],strlen(tag_name[i]));
+	openwidth = XTextWidth(fontstruct,"[",1);
+	commawidth = XTextWidth(fontstruct,", ",2);
+	closewidth = XTextWidth(fontstruct,"]",1);
+	targetwidth = XTextWidth(fontstruct,"[all]",5);
+	targetstep = XTextWidth(fontstruct,"[all]",4);	/* the title has always sat here */
 #ifdef __SCWM_ICONS_H__
-	XAllocNamedColor(dpy,cmap,colors[Background],&color,&color);
 	bgc = DefaultGC(dpy,scr);
-	XSetForeground(dpy,bgc,color.pixel);
-	iconbuf = XCreatePixmap(dpy,root,iconwidth,iconheight,DefaultDepth(dpy,scr));
+	XSetBackground(dpy,bgc,pixels[Background]);
+	for (i = 0; i < sizeof(icons)/sizeof(icons[0]); i++)
+		iconmask[i] = XCreateBitmapFromData(dpy,root,(char *) icons[i].bits,iconwidth,iconheight);
 #endif
 	XSetWindowAttributes wa;
 	wa.override_redirect = True;
 	wa.event_mask = ExposureMask;
 	XChangeWindowAttributes(dpy,bar,CWOverrideRedirect|CWEventMask,&wa);
 	XMapWindow(dpy,bar);
+	if (canvasmode) {
+		canvasdrawn.x = canvasx = (sw - CANVAS)/2;
+		canvasdrawn.y = canvasy = (sh - CANVAS)/2;
+		wa.background_pixmap = ParentRelative;
+		wa.event_mask = SubstructureNotifyMask | SubstructureRedirectMask |
+				ButtonPressMask | ButtonReleaseMask;
+		canvas = XCreateWindow(dpy,root,canvasx,canvasy,CANVAS,CANVAS,0,
+				CopyFromParent,InputOutput,CopyFromParent,
+				CWOverrideRedirect|CWBackPixmap|CWEventMask,&wa);
+		XLowerWindow(dpy,canvas);
+		XMapWindow(dpy,canvas);
+	}
+	if (overviewzoom && XCompositeQueryExtension(dpy,&i,&j) && XRenderQueryExtension(dpy,&i,&j)) {
+		wa.event_mask = ButtonPressMask | ExposureMask;
+		ov.win = XCreateWindow(dpy,root,0,0,sw,sh,0,CopyFromParent,InputOutput,
+				CopyFromParent,CWOverrideRedirect|CWEventMask,&wa);
+		ov.back = XCreatePixmap(dpy,root,sw,sh,DefaultDepth(dpy,scr));
+		ov.dst = XRenderCreatePicture(dpy,ov.back,
+				XRenderFindVisualFormat(dpy,DefaultVisual(dpy,scr)),0,NULL);
+		/* redirecting only on entry would show previews before clients repaint */
+		XCompositeRedirectSubwindows(dpy,root,CompositeRedirectAutomatic);
+		if (canvasmode) XCompositeRedirectSubwindows(dpy,canvas,CompositeRedirectAutomatic);
+	}
 	wa.event_mask = FocusChangeMask | SubstructureNotifyMask | ButtonPressMask |
 			ButtonReleaseMask | PropertyChangeMask | SubstructureRedirectMask |
 			StructureNotifyMask;
@@ -1112,7 +2470,6 @@ int main(int argc, const char **argv) {
 	unsigned int mods[] = {0, LockMask, Mod2Mask, LockMask|Mod2Mask};
 	KeyCode code;
 	XUngrabKey(dpy,AnyKey,AnyModifier,root);
-	int i,j;
 	for (i = 0; i < sizeof(keys)/sizeof(keys[0]); i++)
 		if ( (code=XKeysymToKeycode(dpy,keys[i].keysym)) ) for (j = 0; j < 4; j++)
 			XGrabKey(dpy,code,keys[i].mod|mods[j],root,True,
@@ -1124,34 +2481,96 @@ int main(int argc, const char **argv) {
 	/* main loop */
 	curtile[0] = tile_modes[0][0];
 	draw(clients);
-    XEvent ev;
-	int xfd, sfd;
-	fd_set fds;
-	sfd = fileno(inpipe);
+	int xfd, efd, tfd;
+	struct epoll_event ee, ready[3+2*STATUS_SOURCES];
+	struct itimerspec its;
+	unsigned long long expired;
+	double next, armed = 0;
 	xfd = ConnectionNumber(dpy);
-	char *line = (char *) calloc(max_status_line+1,sizeof(char));
+	/* animation, zoom debounce and sync timeouts share one timerfd */
+	efd = epoll_create1(EPOLL_CLOEXEC);
+	tfd = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+	memset(&its,0,sizeof(its));
+	ee.events = EPOLLIN;
+	ee.data.fd = xfd; epoll_ctl(efd,EPOLL_CTL_ADD,xfd,&ee);
+	for (i = 0; i < nsources; i++) {
+		sources[i].fd = fileno(sources[i].pipe);
+		fcntl(sources[i].fd,F_SETFL,fcntl(sources[i].fd,F_GETFL) | O_NONBLOCK);
+		ee.data.fd = sources[i].fd; epoll_ctl(efd,EPOLL_CTL_ADD,sources[i].fd,&ee);
+		if (sources[i].shm) {
+			ee.data.fd = sources[i].efd; epoll_ctl(efd,EPOLL_CTL_ADD,sources[i].efd,&ee);
+		}
+	}
+	ee.data.fd = tfd; epoll_ctl(efd,EPOLL_CTL_ADD,tfd,&ee);
 	while (running) {
-		FD_ZERO(&fds);
-		FD_SET(sfd,&fds);
-		FD_SET(xfd,&fds);
-		select(xfd+1,&fds,0,0,NULL);
-		if (FD_ISSET(xfd,&fds)) while (XPending(dpy)) {
-			XNextEvent(dpy,&ev);
-			if (handler[ev.type]) handler[ev.type](&ev);
+		/* everything queued by the last batch goes out in one flush */
+		XFlush(dpy);
+		if (!XEventsQueued(dpy,QueuedAlready)) {
+			next = (anim.active ? anim.next : 0);
+			if (gesture.active && (!next || gesture.due < next)) next = gesture.due;
+			if (syncwaiting && (!next || syncdue < next)) next = syncdue;
+			for (i = 0; i < nsources; i++) if ((src=&sources[i])->pending)
+				if (!next || src->last + 1.0/src->rate < next) next = src->last + 1.0/src->rate;
+			if (next != armed) {
+				/* a zero value disarms; round up so it never fires early */
+				its.it_value.tv_sec = next;
+				its.it_value.tv_nsec = (next ? MIN((next - its.it_value.tv_sec) * 1e9 + 1,999999999) : 0);
+				timerfd_settime(tfd,TFD_TIMER_ABSTIME,&its,NULL);
+				armed = next;
+			}
+			n = epoll_wait(efd,ready,sizeof(ready)/sizeof(ready[0]),-1);
+			for (i = 0; i < n; i++) {
+				if (ready[i].data.fd == tfd && read(tfd,&expired,sizeof(expired)) > 0)
+					armed = 0;
+				for (j = 0; j < nsources; j++) {
+					if (ready[i].data.fd == sources[j].fd) sources[j].ready = True;
+					if (ready[i].data.fd == sources[j].efd) sources[j].rung = True;
+				}
+			}
 		}
-		if (FD_ISSET(sfd,&fds)) {
-			if (fgets(line,max_status_line,inpipe))
-				status(line);
+		while (dispatch());
+		/* each source repaints its own segment at most rate times a second,
+		 * always with its newest line; a stalled one holds up nothing */
+		for (i = 0; i < nsources; i++) {
+			src = &sources[i];
+			if (src->ready && !status_read(src))
+				epoll_ctl(efd,EPOLL_CTL_DEL,src->fd,NULL);
+			else if (src->ready) src->fromshm = False;
+			/* a doorbell always means the newest snapshot, whatever came before */
+			if (src->rung && read(src->efd,&expired,sizeof(expired)) > 0)
+				src->pending = src->fromshm = True;
+			src->ready = src->rung = False;
+			if (src->pending && monotonic() >= src->last + 1.0/src->rate) {
+				src->pending = False;
+				src->last = monotonic();
+				if (src->fromshm) status_shm(src);
+				else status(src,src->line);
+			}
 		}
+		if (gesture.active && monotonic() >= gesture.due) gesture_commit();
+		if (syncwaiting && monotonic() >= syncdue) sync_expire();
+		if (anim.active && monotonic() >= anim.next) animate_frame();
 	}
 	/* clean up */
+	Client *c;
+	for (c = clients; c; c = c->next)
+		if (canvasmode && c->drawn.parent == canvas)
+			XReparentWindow(dpy,c->win,root,CX(c),CY(c));
+	if (poolstats) {
+		fprintf(stderr,"clients: live=%d peak=%d\ncheckpoints: live=%d peak=%d\n",
+			client_pool.live,client_pool.peak,checkpoint_pool.live,checkpoint_pool.peak);
+		for (i = 0; i < sizeof(title_pool)/sizeof(title_pool[0]); i++)
+			fprintf(stderr,"titles[%d]: live=%d peak=%d\n",(int)title_pool[i].size,
+				title_pool[i].live,title_pool[i].peak);
+	}
 	Checkpoint *cp = checks;
 	while (checks) {
 		cp = checks;
 		checks = checks->next;
-		free(cp);
+		pool_put(&checkpoint_pool,cp);
 	}
-	free(line);
+	close(tfd);
+	close(efd);
 	XFreeFontInfo(NULL,fontstruct,1);
 	XUnloadFont(dpy,val.font);
 	return 0;
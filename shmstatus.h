@@ -0,0 +1,36 @@
+#ifndef __SCWM_SHMSTATUS_H__
+#define __SCWM_SHMSTATUS_H__		"SCWM Shared Status 0.1"
+
+/* Binary status channel between a producer and scrollwm.
+ *
+ * scrollwm maps a ShmStatus for each status command and passes two
+ * inherited descriptors in the environment: SCROLLWM_STATUS_SHM (the
+ * shared memory) and SCROLLWM_STATUS_FD (an eventfd doorbell).  The
+ * producer fills slot[head % SHMSTATUS_SLOTS], publishes it by storing
+ * head+1, then writes 1 to the eventfd.  The reader copies the newest
+ * slot and retries if the producer lapped it meanwhile. */
+
+#define SHMSTATUS_MAGIC		0x5343574D
+#define SHMSTATUS_SLOTS		4
+#define SHMSTATUS_SEGS		32
+#define SHMSTATUS_TEXT		24
+
+typedef struct {
+	unsigned int rgb;
+	int icon;				/* -1 for none */
+	char text[SHMSTATUS_TEXT];
+} ShmSegment;
+
+typedef struct {
+	int n;
+	ShmSegment seg[SHMSTATUS_SEGS];
+} ShmSnapshot;
+
+typedef struct {
+	unsigned int magic;
+	unsigned int head;		/* snapshots published so far */
+	ShmSnapshot slot[SHMSTATUS_SLOTS];
+} ShmStatus;
+
+// vim: ts=4
+#endif /* __SCWM_SHMSTATUS_H__ */